@@ -27,11 +27,18 @@
  *  Handling BioWare's 2DAs (two-dimensional array).
  */
 
+#include <algorithm>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "common/endianness.h"
 #include "common/util.h"
 #include "common/strutil.h"
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/mutex.h"
 #include "common/streamtokenizer.h"
+#include "common/interntable.h"
 
 #include "aurora/2dafile.h"
 #include "aurora/error.h"
@@ -40,72 +47,101 @@ static const uint32 k2DAID     = MKID_BE('2DA ');
 static const uint32 kVersion2a = MKID_BE('V2.0');
 static const uint32 kVersion2b = MKID_BE('V2.b');
 
+/** The string pool index all empty cells use. */
+static const uint32 kEmptyCell = 0;
+
+typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> StringIndexMap;
+
+/** Start a string pool, with the entry for empty cells. */
+static void initStrings(std::vector<Common::UString> &strings, StringIndexMap &indices) {
+	strings.clear();
+	indices.clear();
+
+	strings.push_back("****");
+
+	indices.insert(std::make_pair(Common::UString("****"), kEmptyCell));
+	indices.insert(std::make_pair(Common::UString(""    ), kEmptyCell));
+}
+
+/** Add a string to a string pool, if it's not already in there, and return its index. */
+static uint32 addString(std::vector<Common::UString> &strings, StringIndexMap &indices,
+                        const Common::UString &str) {
+
+	std::pair<StringIndexMap::iterator, bool> result =
+		indices.insert(std::make_pair(str, (uint32) strings.size()));
+
+	if (result.second)
+		strings.push_back(str);
+
+	return result.first->second;
+}
+
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
+/** All column headers found in any 2DA so far, each with a unique ID.
+ *
+ *  Headers are case-insensitive, so headers differing only in case
+ *  share the same ID.
+ */
+typedef Common::InternTable<Common::hashUStringCaseInsensitive,
+                             Common::equalsUStringCaseInsensitive> HeaderTable;
+
+static HeaderTable &getHeaderTable() {
+	static HeaderTable headerTable;
+
+	return headerTable;
 }
 
-TwoDARow::~TwoDARow() {
+
+TwoDAColumnID::TwoDAColumnID(const Common::UString &header) {
+	HeaderTable &headerTable = getHeaderTable();
+	Common::StackLock lock(headerTable.mutex);
+
+	_id = headerTable.intern(header);
 }
 
-const Common::UString &TwoDARow::getString(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
 
-	return cell;
+TwoDARow::TwoDARow(TwoDAFile &parent, uint32 row) : _parent(&parent), _row(row) {
 }
 
-const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
+const Common::UString &TwoDARow::getString(uint32 column) const {
+	return _parent->getString(_row, column);
+}
 
-	return cell;
+const Common::UString &TwoDARow::getString(const Common::UString &column) const {
+	return _parent->getString(_row, _parent->headerToColumn(column));
 }
 
 const int32 TwoDARow::getInt(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_row, column);
 }
 
 const int32 TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_row, _parent->headerToColumn(column));
 }
 
 const float TwoDARow::getFloat(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getFloat(_row, column);
 }
 
 const float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
+	return _parent->getFloat(_row, _parent->headerToColumn(column));
+}
 
-	return _parent->parseFloat(cell);
+const Common::UString &TwoDARow::getString(const TwoDAColumnID &column) const {
+	return _parent->getString(_row, _parent->headerToColumn(column));
 }
 
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(uint32 n) const {
-	if (n >= _data.size())
-		return kEmpty;
+const int32 TwoDARow::getInt(const TwoDAColumnID &column) const {
+	return _parent->getInt(_row, _parent->headerToColumn(column));
+}
 
-	return _data[n];
+const float TwoDARow::getFloat(const TwoDAColumnID &column) const {
+	return _parent->getFloat(_row, _parent->headerToColumn(column));
 }
 
 
-TwoDAFile::TwoDAFile() : _defaultInt(0), _defaultFloat(0.0), _emptyRow(*this) {
+TwoDAFile::TwoDAFile() : _defaultInt(0), _defaultFloat(0.0), _emptyRow(*this, kFieldIDInvalid) {
 }
 
 TwoDAFile::~TwoDAFile() {
@@ -116,12 +152,16 @@ void TwoDAFile::clear() {
 	AuroraBase::clear();
 
 	_headers.clear();
-
-	for (std::vector<TwoDARow *>::iterator row = _rows.begin(); row != _rows.end(); ++row)
-		delete *row;
 	_rows.clear();
 
+	_strings.clear();
+	_cells.clear();
+
+	_ints.clear();
+	_floats.clear();
+
 	_headerMap.clear();
+	_columnIDs.clear();
 
 	_defaultString.clear();
 	_defaultInt   = 0;
@@ -210,23 +250,29 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 
 	uint32 columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		TwoDARow *row = new TwoDARow(*this);
+	StringIndexMap stringIndices;
+	initStrings(_strings, stringIndices);
 
+	std::vector<uint32> rowCells;
+	std::vector<Common::UString> row;
+
+	while (!twoda.eos()) {
 		tokenize.skipToken(twoda);
 
-		int count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount);
+		row.clear();
+		int count = tokenize.getTokens(twoda, row, columnCount, columnCount);
 
 		tokenize.nextChunk(twoda);
 
-		if (count == 0) {
+		if (count == 0)
 			// Ignore empty lines
-			delete row;
 			continue;
-		}
 
-		_rows.push_back(row);
+		for (std::vector<Common::UString>::const_iterator c = row.begin(); c != row.end(); ++c)
+			rowCells.push_back(addString(_strings, stringIndices, *c));
 	}
+
+	createColumns(rowCells);
 }
 
 void TwoDAFile::readHeaders2b(Common::SeekableReadStream &twoda) {
@@ -248,7 +294,7 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 
 	_rows.reserve(rowCount);
 	for (uint32 i = 0; i < rowCount; i++)
-		_rows.push_back(0);
+		_rows.push_back(TwoDARow(*this, i));
 
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
@@ -263,44 +309,118 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 	uint32 rowCount    = _rows.size();
 	uint32 cellCount   = columnCount * rowCount;
 
-	uint32 *offsets = new uint32[cellCount];
+	// The offsets of each cell's string, relative to the start of the string data
+	std::vector<byte> offsets(cellCount * 2);
+	if (!offsets.empty() && (twoda.read(&offsets[0], offsets.size()) != offsets.size()))
+		throw Common::Exception(Common::kReadError);
 
-	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
+	twoda.skip(2); // Reserved
 
-	tokenize.addSeparator('\0');
+	// The strings are only a few KB at most, so read them in one go
+	std::vector<byte> data(twoda.size() - twoda.pos());
+	if (!data.empty() && (twoda.read(&data[0], data.size()) != data.size()))
+		throw Common::Exception(Common::kReadError);
 
-	for (uint32 i = 0; i < cellCount; i++)
-		offsets[i] = twoda.readUint16LE();
+	StringIndexMap stringIndices;
+	initStrings(_strings, stringIndices);
 
-	twoda.skip(2); // Reserved
+	// Identical strings are usually only stored once, so remember which offset is which string
+	boost::unordered_map<uint32, uint32> offsetIndices;
 
-	uint32 dataOffset = twoda.pos();
+	std::vector<uint32> rowCells(cellCount);
+	for (uint32 i = 0; i < cellCount; i++) {
+		uint32 offset = READ_LE_UINT16(&offsets[i * 2]);
 
-	for (uint32 i = 0; i < rowCount; i++) {
-		_rows[i] = new TwoDARow(*this);
+		std::pair<boost::unordered_map<uint32, uint32>::iterator, bool> result =
+			offsetIndices.insert(std::make_pair(offset, 0));
 
-		_rows[i]->_data.resize(columnCount);
+		if (result.second) {
+			if (offset > data.size())
+				throw Common::Exception(Common::kSeekError);
 
-		for (uint32 j = 0; j < columnCount; j++) {
-			uint32 offset = dataOffset + offsets[i * columnCount + j];
+			const char *str = (const char *) (data.empty() ? 0 : &data[0]) + offset;
 
-			if (!twoda.seek(offset)) {
-				delete[] offsets;
-				throw Common::Exception(Common::kSeekError);
-			}
+			uint32 length = 0;
+			while (((offset + length) < data.size()) && (str[length] != '\0'))
+				length++;
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+			result.first->second = addString(_strings, stringIndices, Common::UString(str, length));
 		}
+
+		rowCells[i] = result.first->second;
 	}
 
-	delete[] offsets;
+	createColumns(rowCells);
 }
 
 void TwoDAFile::createHeaderMap() {
 	for (uint32 i = 0; i < _headers.size(); i++)
 		_headerMap.insert(std::make_pair(_headers[i], i));
+
+	// Resolve the headers into their IDs, for TwoDAColumnID lookups
+	HeaderTable &headerTable = getHeaderTable();
+	Common::StackLock lock(headerTable.mutex);
+
+	_columnIDs.reserve(_headers.size());
+	for (uint32 i = 0; i < _headers.size(); i++)
+		_columnIDs.push_back(ColumnID(headerTable.intern(_headers[i]), i));
+
+	// Sort by ID. If a header appears twice, the first column wins, like in the header map
+	std::sort(_columnIDs.begin(), _columnIDs.end());
+}
+
+void TwoDAFile::createColumns(const std::vector<uint32> &rowCells) {
+	const uint32 columnCount = _headers.size();
+	const uint32 rowCount    = (columnCount > 0) ? (rowCells.size() / columnCount) : 0;
+
+	// ASCII 2DAs only now know how many rows they have
+	for (uint32 i = _rows.size(); i < rowCount; i++)
+		_rows.push_back(TwoDARow(*this, i));
+
+	// Store the cells of each column next to each other
+	_cells.resize(columnCount * rowCount);
+	for (uint32 i = 0; i < rowCount; i++)
+		for (uint32 j = 0; j < columnCount; j++)
+			_cells[j * rowCount + i] = rowCells[i * columnCount + j];
+
+	// Parse every distinct cell content once, so that the accessors only look them up
+	_ints.resize(_strings.size());
+	_floats.resize(_strings.size());
+	for (uint32 i = 0; i < _strings.size(); i++) {
+		_ints  [i] = parseInt  (_strings[i]);
+		_floats[i] = parseFloat(_strings[i]);
+	}
+}
+
+uint32 TwoDAFile::getCell(uint32 row, uint32 column) const {
+	if ((row >= _rows.size()) || (column >= _headers.size()))
+		return kEmptyCell;
+
+	return _cells[column * _rows.size() + row];
+}
+
+const Common::UString &TwoDAFile::getString(uint32 row, uint32 column) const {
+	const uint32 cell = getCell(row, column);
+	if (cell == kEmptyCell)
+		return _defaultString;
+
+	return _strings[cell];
+}
+
+int32 TwoDAFile::getInt(uint32 row, uint32 column) const {
+	const uint32 cell = getCell(row, column);
+	if (cell == kEmptyCell)
+		return _defaultInt;
+
+	return _ints[cell];
+}
+
+float TwoDAFile::getFloat(uint32 row, uint32 column) const {
+	const uint32 cell = getCell(row, column);
+	if (cell == kEmptyCell)
+		return _defaultFloat;
+
+	return _floats[cell];
 }
 
 uint32 TwoDAFile::getRowCount() const {
@@ -324,12 +444,23 @@ uint32 TwoDAFile::headerToColumn(const Common::UString &header) const {
 	return column->second;
 }
 
+uint32 TwoDAFile::headerToColumn(const TwoDAColumnID &header) const {
+	std::vector<ColumnID>::const_iterator column =
+		std::lower_bound(_columnIDs.begin(), _columnIDs.end(), ColumnID(header._id, 0));
+
+	if ((column == _columnIDs.end()) || (column->first != header._id))
+		// No such header
+		return kFieldIDInvalid;
+
+	return column->second;
+}
+
 const TwoDARow &TwoDAFile::getRow(uint32 row) const {
-	if ((row >= _rows.size()) || !_rows[row])
+	if (row >= _rows.size())
 		// No such row
 		return _emptyRow;
 
-	return *_rows[row];
+	return _rows[row];
 }
 
 bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
@@ -354,8 +485,8 @@ bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
 		colLength[i + 1] = _headers[i].size();
 
 	for (uint32 i = 0; i < _rows.size(); i++)
-		for (uint32 j = 0; j < _rows[i]->_data.size(); j++)
-			colLength[j + 1] = MAX<uint32>(colLength[j + 1], _rows[i]->_data[j].size());
+		for (uint32 j = 0; j < _headers.size(); j++)
+			colLength[j + 1] = MAX<uint32>(colLength[j + 1], _strings[getCell(i, j)].size());
 
 	// Write column headers
 
@@ -371,8 +502,8 @@ bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
 	for (uint32 i = 0; i < _rows.size(); i++) {
 		file.writeString(Common::UString::sprintf("%*d", colLength[0], i));
 
-		for (uint32 j = 0; j < _rows[i]->_data.size(); j++)
-			file.writeString(Common::UString::sprintf(" %-*s", colLength[j + 1], _rows[i]->_data[j].c_str()));
+		for (uint32 j = 0; j < _headers.size(); j++)
+			file.writeString(Common::UString::sprintf(" %-*s", colLength[j + 1], _strings[getCell(i, j)].c_str()));
 
 		file.writeByte('\n');
 	}
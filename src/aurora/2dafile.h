@@ -31,7 +31,8 @@
 #define AURORA_2DAFILE_H
 
 #include <vector>
-#include <map>
+
+#include <boost/unordered/unordered_map.hpp>
 
 #include "common/types.h"
 #include "common/ustring.h"
@@ -48,6 +49,23 @@ namespace Aurora {
 
 class TwoDAFile;
 
+/** A pre-resolved 2DA column header.
+ *
+ *  Looking up a column by its header string means hashing that string
+ *  first. Code that looks up the same columns over and over can instead
+ *  resolve each header once into a (usually static) TwoDAColumnID, and
+ *  then use that for the lookups, in any 2DA.
+ */
+class TwoDAColumnID {
+public:
+	explicit TwoDAColumnID(const Common::UString &header);
+
+private:
+	uint32 _id; ///< The ID of the header.
+
+	friend class TwoDAFile;
+};
+
 class TwoDARow {
 public:
 	/** Return the contents of a cell as a string. */
@@ -65,20 +83,28 @@ public:
 	/** Return the contents of a cell as a float. */
 	const float getFloat(const Common::UString &column) const;
 
+	/** Return the contents of a cell as a string. */
+	const Common::UString &getString(const TwoDAColumnID &column) const;
+	/** Return the contents of a cell as an int. */
+	const int32 getInt(const TwoDAColumnID &column) const;
+	/** Return the contents of a cell as a float. */
+	const float getFloat(const TwoDAColumnID &column) const;
+
 private:
 	TwoDAFile *_parent; ///< The parent 2DA.
+	uint32     _row;    ///< The index of the row.
 
-	std::vector<Common::UString> _data;
-
-	TwoDARow(TwoDAFile &parent);
-	~TwoDARow();
-
-	const Common::UString &getCell(uint32 n) const;
+	TwoDARow(TwoDAFile &parent, uint32 row);
 
 	friend class TwoDAFile;
 };
 
-/** Class to hold the two-dimensional array of a 2DA file. */
+/** Class to hold the two-dimensional array of a 2DA file.
+ *
+ *  All cells are parsed as ints and floats while loading, so a loaded
+ *  2DA is never modified by its accessors and can be read from several
+ *  threads at once.
+ */
 class TwoDAFile : public AuroraBase {
 public:
 	TwoDAFile();
@@ -104,6 +130,8 @@ public:
 
 	/** Translate a column header to a column index. */
 	uint32 headerToColumn(const Common::UString &header) const;
+	/** Translate a pre-resolved column header to a column index. */
+	uint32 headerToColumn(const TwoDAColumnID &header) const;
 
 	/** Get a row. */
 	const TwoDARow &getRow(uint32 row) const;
@@ -112,7 +140,12 @@ public:
 	bool dumpASCII(const Common::UString &fileName) const;
 
 private:
-	typedef std::map<Common::UString, uint32, Common::UString::iless> HeaderMap;
+	typedef boost::unordered_map<Common::UString, uint32,
+	                             Common::hashUStringCaseInsensitive,
+	                             Common::equalsUStringCaseInsensitive> HeaderMap;
+
+	/** A header ID and the index of the column with that header. */
+	typedef std::pair<uint32, uint32> ColumnID;
 
 	Common::UString _defaultString; ///< The default string to return should a cell not exist.
 	int32           _defaultInt;    ///< The default int to return should a cell not exist.
@@ -121,8 +154,22 @@ private:
 	std::vector<Common::UString> _headers;
 	HeaderMap _headerMap;
 
+	/** The columns by the IDs of their headers, sorted by ID. */
+	std::vector<ColumnID> _columnIDs;
+
 	TwoDARow _emptyRow;
-	std::vector<TwoDARow *> _rows;
+	std::vector<TwoDARow> _rows;
+
+	/** All distinct cell contents. Empty cells all use the first string. */
+	std::vector<Common::UString> _strings;
+
+	/** The cells, column after column, as indices into the string pool. */
+	std::vector<uint32> _cells;
+
+	/** All distinct cell contents parsed as ints. */
+	std::vector<int32> _ints;
+	/** All distinct cell contents parsed as floats. */
+	std::vector<float> _floats;
 
 	// Loading helpers
 	void read2a(Common::SeekableReadStream &twoda);
@@ -139,6 +186,14 @@ private:
 	void readRows2b    (Common::SeekableReadStream &twoda);
 
 	void createHeaderMap();
+	void createColumns(const std::vector<uint32> &rowCells);
+
+	// Cell access helpers
+	uint32 getCell(uint32 row, uint32 column) const;
+
+	const Common::UString &getString(uint32 row, uint32 column) const;
+	int32                  getInt   (uint32 row, uint32 column) const;
+	float                  getFloat (uint32 row, uint32 column) const;
 
 	static int32 parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
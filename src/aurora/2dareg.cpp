@@ -53,6 +53,10 @@ void TwoDARegistry::clear() {
 }
 
 const TwoDAFile &TwoDARegistry::get(const Common::UString &name) {
+	return get(Common::Atom(name));
+}
+
+const TwoDAFile &TwoDARegistry::get(const Common::Atom &name) {
 	TwoDAMap::const_iterator twoda = _twodas.find(name);
 	if (twoda != _twodas.end())
 		// Entry exists => return
@@ -60,7 +64,7 @@ const TwoDAFile &TwoDARegistry::get(const Common::UString &name) {
 
 	// Entry doesn't exist => load and add
 
-	TwoDAFile *newTwoDA = load(name);
+	TwoDAFile *newTwoDA = load(name.getName());
 
 	std::pair<TwoDAMap::iterator, bool> result;
 	result = _twodas.insert(std::make_pair(name, newTwoDA));
@@ -69,7 +73,9 @@ const TwoDAFile &TwoDARegistry::get(const Common::UString &name) {
 }
 
 void TwoDARegistry::add(const Common::UString &name) {
-	TwoDAMap::iterator twoda = _twodas.find(name);
+	const Common::Atom atom(name);
+
+	TwoDAMap::iterator twoda = _twodas.find(atom);
 	if (twoda != _twodas.end()) {
 		// Entry exists => remove first
 		delete twoda->second;
@@ -77,11 +83,11 @@ void TwoDARegistry::add(const Common::UString &name) {
 	}
 
 	// Load and add
-	_twodas[name] = load(name);
+	_twodas[atom] = load(name);
 }
 
 void TwoDARegistry::remove(const Common::UString &name) {
-	TwoDAMap::iterator twoda = _twodas.find(name);
+	TwoDAMap::iterator twoda = _twodas.find(Common::Atom(name));
 	if (twoda == _twodas.end())
 		// Does exist, nothing to do
 		return;
@@ -33,6 +33,7 @@
 #include <map>
 
 #include "common/ustring.h"
+#include "common/atom.h"
 #include "common/singleton.h"
 
 #include "aurora/types.h"
@@ -41,7 +42,11 @@ namespace Aurora {
 
 class TwoDAFile;
 
-/** The global 2DA registry, holding all current 2DAs. */
+/** The global 2DA registry, holding all current 2DAs.
+ *
+ *  The 2DAs are indexed by their interned names, so looking up a 2DA
+ *  by a Common::Atom only compares integers.
+ */
 class TwoDARegistry : public Common::Singleton<TwoDARegistry> {
 public:
 	TwoDARegistry();
@@ -51,6 +56,8 @@ public:
 
 	/** Get a certain 2DA, loading it if necessary. */
 	const TwoDAFile &get(const Common::UString &name);
+	/** Get a certain 2DA, loading it if necessary. */
+	const TwoDAFile &get(const Common::Atom &name);
 
 	/** Add a certain 2DA to the registry, reloading it if necessary. */
 	void add(const Common::UString &name);
@@ -58,7 +65,7 @@ public:
 	void remove(const Common::UString &name);
 
 private:
-	typedef std::map<Common::UString, TwoDAFile *> TwoDAMap;
+	typedef std::map<Common::Atom, TwoDAFile *> TwoDAMap;
 
 	TwoDAMap _twodas;
 
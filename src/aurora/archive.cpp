@@ -27,18 +27,68 @@
  *  Handling various archive files.
  */
 
+#include "common/error.h"
+#include "common/stream.h"
+
 #include "aurora/archive.h"
 
 namespace Aurora {
 
-Archive::Archive() {
+Archive::Archive(const Common::UString &name) : _name(name) {
 }
 
 Archive::~Archive() {
 }
 
+const Common::UString &Archive::getName() const {
+	return _name;
+}
+
 uint32 Archive::getResourceSize(uint32 index) const {
 	return 0xFFFFFFFF;
 }
 
+uint32 Archive::getResourceOffset(uint32 index) const {
+	return 0xFFFFFFFF;
+}
+
+bool Archive::isThreadSafe() const {
+	return false;
+}
+
+void Archive::writeIndex(Common::WriteStream &index) const {
+	throw Common::Exception("This archive can't write an index");
+}
+
+void Archive::writeIndexResources(Common::WriteStream &index, const ResourceList &resources) {
+	index.writeUint32LE(resources.size());
+
+	for (ResourceList::const_iterator res = resources.begin(); res != resources.end(); ++res) {
+		index.writeString(res->name);
+		index.writeByte(0);
+
+		index.writeUint32LE((uint32) res->type);
+		index.writeUint32LE(res->index);
+	}
+}
+
+void Archive::readIndexResources(Common::SeekableReadStream &index, ResourceList &resources) {
+	uint32 count = index.readUint32LE();
+
+	// Each resource takes up at least 9 bytes
+	if (count > (((uint32) (index.size() - index.pos())) / 9))
+		throw Common::Exception("Archive index too short");
+
+	resources.resize(count);
+	for (ResourceList::iterator res = resources.begin(); res != resources.end(); ++res) {
+		res->name.readASCII(index);
+
+		res->type  = (FileType) index.readUint32LE();
+		res->index = index.readUint32LE();
+	}
+
+	if (index.err() || index.eos())
+		throw Common::Exception(Common::kReadError);
+}
+
 } // End of namespace Aurora
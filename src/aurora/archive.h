@@ -39,6 +39,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -55,9 +56,12 @@ public:
 
 	typedef std::list<Resource> ResourceList;
 
-	Archive();
+	Archive(const Common::UString &name = "");
 	virtual ~Archive();
 
+	/** Return the name of the archive, usually the path of its file. */
+	const Common::UString &getName() const;
+
 	/** Clear the resource list. */
 	virtual void clear() = 0;
 
@@ -67,8 +71,29 @@ public:
 	/** Return the size of a resource. */
 	virtual uint32 getResourceSize(uint32 index) const;
 
+	/** Return the offset of a resource within the archive file, or 0xFFFFFFFF if unknown. */
+	virtual uint32 getResourceOffset(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	virtual Common::SeekableReadStream *getResource(uint32 index) const = 0;
+
+	/** Can resources be read out of the archive by several threads at once? */
+	virtual bool isThreadSafe() const;
+
+	/** Write an index of the archive's resources.
+	 *
+	 *  Archives that support it can be recreated out of such an index,
+	 *  without having to parse the archive file again.
+	 */
+	virtual void writeIndex(Common::WriteStream &index) const;
+
+protected:
+	Common::UString _name; ///< The name of the archive.
+
+	/** Write a list of resources into an archive index. */
+	static void writeIndexResources(Common::WriteStream &index, const ResourceList &resources);
+	/** Read a list of resources out of an archive index. */
+	static void readIndexResources(Common::SeekableReadStream &index, ResourceList &resources);
 };
 
 } // End of namespace Aurora
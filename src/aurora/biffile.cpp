@@ -31,10 +31,12 @@
 #include "common/error.h"
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/mappedfile.h"
 
 #include "aurora/biffile.h"
 #include "aurora/keyfile.h"
 #include "aurora/error.h"
+#include "aurora/resman.h"
 
 static const uint32 kBIFID     = MKID_BE('BIFF');
 static const uint32 kVersion1  = MKID_BE('V1  ');
@@ -42,10 +44,17 @@ static const uint32 kVersion11 = MKID_BE('V1.1');
 
 namespace Aurora {
 
-BIFFile::BIFFile(const Common::UString &fileName) : _fileName(fileName) {
+BIFFile::BIFFile(const Common::UString &fileName) : Archive(fileName), _fileName(fileName) {
 	load();
 }
 
+BIFFile::BIFFile(const Common::UString &fileName, Common::SeekableReadStream &index) :
+	Archive(fileName), _fileName(fileName) {
+
+	map();
+	readIndex(index);
+}
+
 BIFFile::~BIFFile() {
 }
 
@@ -54,6 +63,8 @@ void BIFFile::clear() {
 }
 
 void BIFFile::load() {
+	map();
+
 	Common::File bif;
 	open(bif);
 
@@ -93,15 +104,23 @@ void BIFFile::readVarResTable(Common::SeekableReadStream &bif, uint32 offset) {
 	if (!bif.seek(offset))
 		throw Common::Exception(Common::kSeekError);
 
-	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
-		bif.skip(4); // ID
+	// Version 1.1 has an additional flags field
+	const uint32 entrySize = (_version == kVersion11) ? 20 : 16;
+
+	if (_iResources.size() > (((uint32) (bif.size() - bif.pos())) / entrySize))
+		throw Common::Exception("Resource table goes beyond end of file");
 
-		if (_version == kVersion11)
-			bif.skip(4); // Flags
+	// Read the whole table at once, and decode it from memory
+	std::vector<byte> table(_iResources.size() * entrySize);
+	if (!table.empty() && (bif.read(&table[0], table.size()) != table.size()))
+		throw Common::Exception(Common::kReadError);
 
-		res->offset = bif.readUint32LE();
-		res->size   = bif.readUint32LE();
-		res->type   = (FileType) bif.readUint32LE();
+	// Skip the ID, and the flags
+	const byte *entry = table.empty() ? 0 : (&table[0] + entrySize - 12);
+	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res, entry += entrySize) {
+		res->offset = READ_LE_UINT32(entry + 0);
+		res->size   = READ_LE_UINT32(entry + 4);
+		res->type   = (FileType) READ_LE_UINT32(entry + 8);
 	}
 }
 
@@ -119,11 +138,11 @@ void BIFFile::mergeKEY(const KEYFile &key, uint32 bifIndex) {
 
 		if (keyRes->type != _iResources[keyRes->resIndex].type)
 			warning("KEY and BIF disagree on the type of the resource \"%s\" (%d, %d). Trusting the BIF",
-			        keyRes->name.c_str(), keyRes->type, _iResources[keyRes->resIndex].type);
+			        keyRes->getName().c_str(), keyRes->type, _iResources[keyRes->resIndex].type);
 
 		Resource res;
 
-		res.name  = keyRes->name;
+		res.name  = keyRes->getName();
 		res.type  = _iResources[keyRes->resIndex].type;
 		res.index = keyRes->resIndex;
 
@@ -132,6 +151,35 @@ void BIFFile::mergeKEY(const KEYFile &key, uint32 bifIndex) {
 
 }
 
+void BIFFile::readIndex(Common::SeekableReadStream &index) {
+	uint32 iResCount = index.readUint32LE();
+
+	// Each resource takes up 12 bytes
+	if (iResCount > (((uint32) (index.size() - index.pos())) / 12))
+		throw Common::Exception("BIF index too short");
+
+	_iResources.resize(iResCount);
+	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		res->type   = (FileType) index.readUint32LE();
+		res->offset = index.readUint32LE();
+		res->size   = index.readUint32LE();
+	}
+
+	readIndexResources(index, _resources);
+}
+
+void BIFFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32LE(_iResources.size());
+
+	for (IResourceList::const_iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		index.writeUint32LE((uint32) res->type);
+		index.writeUint32LE(res->offset);
+		index.writeUint32LE(res->size);
+	}
+
+	writeIndexResources(index, _resources);
+}
+
 const Archive::ResourceList &BIFFile::getResources() const {
 	return _resources;
 }
@@ -147,25 +195,37 @@ uint32 BIFFile::getResourceSize(uint32 index) const {
 	return getIResource(index).size;
 }
 
+uint32 BIFFile::getResourceOffset(uint32 index) const {
+	return getIResource(index).offset;
+}
+
 Common::SeekableReadStream *BIFFile::getResource(uint32 index) const {
 	const IResource &res = getIResource(index);
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File bif;
-	open(bif);
+	if (_mappedFile) {
+		// Hand out a view into the mapped BIF, without copying anything
+		if ((res.offset > _mappedFile->size()) || (res.size > (_mappedFile->size() - res.offset)))
+			throw Common::Exception(Common::kReadError);
 
-	if (!bif.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
+	}
 
-	Common::SeekableReadStream *resStream = bif.readStream(res.size);
+	// Borrow an open BIF file handle from the resource manager
+	boost::shared_ptr<Common::File> bif = ResMan.getArchiveFile(_fileName);
 
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
+	byte *data = new byte[res.size];
+	if (bif->readAt(res.offset, data, res.size) != res.size) {
+		delete[] data;
 		throw Common::Exception(Common::kReadError);
 	}
 
-	return resStream;
+	return new Common::MemoryReadStream(data, res.size, true);
+}
+
+bool BIFFile::isThreadSafe() const {
+	return true;
 }
 
 void BIFFile::open(Common::File &file) const {
@@ -173,4 +233,11 @@ void BIFFile::open(Common::File &file) const {
 		throw Common::Exception(Common::kOpenError);
 }
 
+void BIFFile::map() {
+	// If the system can't map the file, we'll read the resources out of it instead
+	_mappedFile.reset(new Common::MappedFile);
+	if (!_mappedFile->open(_fileName))
+		_mappedFile.reset();
+}
+
 } // End of namespace Aurora
@@ -32,6 +32,8 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 #include "common/types.h"
 
 #include "aurora/types.h"
@@ -40,7 +42,9 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 	class File;
+	class MappedFile;
 }
 
 namespace Aurora {
@@ -51,6 +55,8 @@ class KEYFile;
 class BIFFile : public Archive, public AuroraBase {
 public:
 	BIFFile(const Common::UString &fileName);
+	/** Recreate the BIF out of an index written by writeIndex(). */
+	BIFFile(const Common::UString &fileName, Common::SeekableReadStream &index);
 	~BIFFile();
 
 	/** Clear the resource list. */
@@ -62,9 +68,18 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
+	/** Return the offset of a resource within the archive file. */
+	uint32 getResourceOffset(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
+	/** Write an index of the BIF's resources. */
+	void writeIndex(Common::WriteStream &index) const;
+
 	/** Merge information from the KEY into the BIF. */
 	void mergeKEY(const KEYFile &key, uint32 bifIndex);
 
@@ -88,9 +103,14 @@ private:
 	/** The name of the BIF file. */
 	Common::UString _fileName;
 
+	/** The BIF file mapped into memory, if possible. */
+	boost::shared_ptr<Common::MappedFile> _mappedFile;
+
 	void open(Common::File &file) const;
+	void map();
 
 	void load();
+	void readIndex(Common::SeekableReadStream &index);
 	void readVarResTable(Common::SeekableReadStream &bif, uint32 offset);
 
 	const IResource &getIResource(uint32 index) const;
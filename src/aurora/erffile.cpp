@@ -29,10 +29,12 @@
 
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/mappedfile.h"
 #include "common/util.h"
 
 #include "aurora/erffile.h"
 #include "aurora/error.h"
+#include "aurora/resman.h"
 #include "aurora/util.h"
 
 static const uint32 kERFID     = MKID_BE('ERF ');
@@ -44,12 +46,19 @@ static const uint32 kVersion2  = MKID_BE('V2.0');
 
 namespace Aurora {
 
-ERFFile::ERFFile(const Common::UString &fileName, bool noResources) :
+ERFFile::ERFFile(const Common::UString &fileName, bool noResources) : Archive(fileName),
 	_noResources(noResources), _fileName(fileName) {
 
 	load();
 }
 
+ERFFile::ERFFile(const Common::UString &fileName, Common::SeekableReadStream &index) :
+	Archive(fileName), _noResources(false), _fileName(fileName) {
+
+	map();
+	readIndex(index);
+}
+
 ERFFile::~ERFFile() {
 }
 
@@ -58,6 +67,8 @@ void ERFFile::clear() {
 }
 
 void ERFFile::load() {
+	map();
+
 	Common::File erf;
 	open(erf);
 
@@ -207,6 +218,33 @@ const LocString &ERFFile::getDescription() const {
 	return _description;
 }
 
+void ERFFile::readIndex(Common::SeekableReadStream &index) {
+	uint32 iResCount = index.readUint32LE();
+
+	// Each resource takes up 8 bytes
+	if (iResCount > (((uint32) (index.size() - index.pos())) / 8))
+		throw Common::Exception("ERF index too short");
+
+	_iResources.resize(iResCount);
+	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		res->offset = index.readUint32LE();
+		res->size   = index.readUint32LE();
+	}
+
+	readIndexResources(index, _resources);
+}
+
+void ERFFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32LE(_iResources.size());
+
+	for (IResourceList::const_iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		index.writeUint32LE(res->offset);
+		index.writeUint32LE(res->size);
+	}
+
+	writeIndexResources(index, _resources);
+}
+
 const Archive::ResourceList &ERFFile::getResources() const {
 	return _resources;
 }
@@ -222,25 +260,37 @@ uint32 ERFFile::getResourceSize(uint32 index) const {
 	return getIResource(index).size;
 }
 
+uint32 ERFFile::getResourceOffset(uint32 index) const {
+	return getIResource(index).offset;
+}
+
 Common::SeekableReadStream *ERFFile::getResource(uint32 index) const {
 	const IResource &res = getIResource(index);
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File erf;
-	open(erf);
+	if (_mappedFile) {
+		// Hand out a view into the mapped ERF, without copying anything
+		if ((res.offset > _mappedFile->size()) || (res.size > (_mappedFile->size() - res.offset)))
+			throw Common::Exception(Common::kReadError);
 
-	if (!erf.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
+	}
 
-	Common::SeekableReadStream *resStream = erf.readStream(res.size);
+	// Borrow an open ERF file handle from the resource manager
+	boost::shared_ptr<Common::File> erf = ResMan.getArchiveFile(_fileName);
 
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
+	byte *data = new byte[res.size];
+	if (erf->readAt(res.offset, data, res.size) != res.size) {
+		delete[] data;
 		throw Common::Exception(Common::kReadError);
 	}
 
-	return resStream;
+	return new Common::MemoryReadStream(data, res.size, true);
+}
+
+bool ERFFile::isThreadSafe() const {
+	return true;
 }
 
 void ERFFile::open(Common::File &file) const {
@@ -248,4 +298,11 @@ void ERFFile::open(Common::File &file) const {
 		throw Common::Exception(Common::kOpenError);
 }
 
+void ERFFile::map() {
+	// If the system can't map the file, we'll read the resources out of it instead
+	_mappedFile.reset(new Common::MappedFile);
+	if (!_mappedFile->open(_fileName))
+		_mappedFile.reset();
+}
+
 } // End of namespace Aurora
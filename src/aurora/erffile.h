@@ -32,6 +32,8 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 #include "common/types.h"
 #include "common/ustring.h"
 
@@ -42,7 +44,9 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 	class File;
+	class MappedFile;
 }
 
 namespace Aurora {
@@ -51,6 +55,8 @@ namespace Aurora {
 class ERFFile : public Archive, public AuroraBase {
 public:
 	ERFFile(const Common::UString &fileName, bool noResources = false);
+	/** Recreate the ERF out of an index written by writeIndex(). The description is not restored. */
+	ERFFile(const Common::UString &fileName, Common::SeekableReadStream &index);
 	~ERFFile();
 
 	/** Clear the resource list. */
@@ -62,9 +68,18 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
+	/** Return the offset of a resource within the archive file. */
+	uint32 getResourceOffset(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
+	/** Write an index of the ERF's resources. */
+	void writeIndex(Common::WriteStream &index) const;
+
 	/** Return the description. */
 	const LocString &getDescription() const;
 
@@ -101,9 +116,14 @@ private:
 	/** The name of the ERF file. */
 	Common::UString _fileName;
 
+	/** The ERF file mapped into memory, if possible. */
+	boost::shared_ptr<Common::MappedFile> _mappedFile;
+
 	void open(Common::File &file) const;
+	void map();
 
 	void load();
+	void readIndex(Common::SeekableReadStream &index);
 
 	void readERFHeader  (Common::SeekableReadStream &erf,       ERFHeader &header);
 	void readDescription(Common::SeekableReadStream &erf, const ERFHeader &header);
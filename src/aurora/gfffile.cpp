@@ -27,10 +27,14 @@
  *  Handling BioWare's GFFs (generic file format).
  */
 
+#include <algorithm>
+
 #include "common/endianness.h"
 #include "common/error.h"
+#include "common/mutex.h"
 #include "common/stream.h"
 #include "common/ustring.h"
+#include "common/interntable.h"
 
 #include "aurora/gfffile.h"
 #include "aurora/error.h"
@@ -41,8 +45,24 @@
 static const uint32 kVersion32 = MKID_BE('V3.2');
 static const uint32 kVersion33 = MKID_BE('V3.3'); // Found in The Witcher, different language table
 
+static const uint32 kNoLabel = 0xFFFFFFFF;
+
 namespace Aurora {
 
+/** All field labels found in any GFF so far, each with a unique ID.
+ *
+ *  Labels are interned once, when a GFF is loaded. Afterwards, fields
+ *  are identified by the ID of their label alone.
+ */
+typedef Common::InternTable<Common::hashUStringCaseSensitive> LabelTable;
+
+static LabelTable &getLabelTable() {
+	static LabelTable labelTable;
+
+	return labelTable;
+}
+
+
 GFFFile::Header::Header() {
 	clear();
 }
@@ -78,41 +98,61 @@ void GFFFile::Header::read(Common::SeekableReadStream &gff) {
 }
 
 
-GFFFile::GFFFile(Common::SeekableReadStream *gff, uint32 id) : _stream(gff) {
-	load(id);
+GFFFile::GFFFile(Common::SeekableReadStream *gff, uint32 id) {
+	assert(gff);
+
+	try {
+		load(*gff, id);
+	} catch (...) {
+		delete gff;
+		throw;
+	}
+
+	delete gff;
 }
 
-GFFFile::GFFFile(const Common::UString &gff, FileType type, uint32 id) : _stream(0) {
-	_stream = ResMan.getResource(gff, type);
-	if (!_stream)
+GFFFile::GFFFile(const Common::UString &gff, FileType type, uint32 id) {
+	Common::SeekableReadStream *res = ResMan.getResource(gff, type);
+	if (!res)
 		throw Common::Exception("No such GFF \"%s\"", setFileType(gff, type).c_str());
 
-	load(id);
+	try {
+		load(*res, id);
+	} catch (...) {
+		delete res;
+		throw;
+	}
+
+	delete res;
 }
 
 GFFFile::~GFFFile() {
-	delete _stream;
-
 	for (StructArray::iterator strct = _structs.begin(); strct != _structs.end(); ++strct)
 		delete *strct;
 }
 
-void GFFFile::load(uint32 id) {
-	readHeader(*_stream);
+void GFFFile::load(Common::SeekableReadStream &gff, uint32 id) {
+	readHeader(gff);
 
 	if (_id != id)
 		throw Common::Exception("GFF has invalid ID (want 0x%08X, got 0x%08X)", id, _id);
 	if ((_version != kVersion32) && (_version != kVersion33))
 		throw Common::Exception("Unsupported GFF file version %08X", _version);
 
-	_header.read(*_stream);
+	_header.read(gff);
 
 	try {
 
-		readStructs();
-		readLists();
+		std::vector<uint32> labels;
+
+		readLabels(gff, labels);
+		readStructs(gff, labels);
+		readLists(gff);
 
-		if (_stream->err())
+		// Copy the field data, so that the GFF doesn't need to read from the stream ever again
+		readTable(gff, _header.fieldDataOffset, _header.fieldDataCount, 1, _fieldData);
+
+		if (gff.err())
 			throw Common::Exception(Common::kReadError);
 
 	} catch (Common::Exception &e) {
@@ -126,6 +166,18 @@ const GFFStruct &GFFFile::getTopLevel() const {
 	return getStruct(0);
 }
 
+void GFFFile::getStrRefs(std::vector<uint32> &strRefs) const {
+	for (FieldArray::const_iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		if (f->type != GFFStruct::kFieldTypeLocString)
+			continue;
+
+		// The strRef follows the size of the localized string
+		uint32 strRef = READ_LE_UINT32(getFieldData(f->data, 8) + 4);
+		if (strRef != kStrRefInvalid)
+			strRefs.push_back(strRef);
+	}
+}
+
 const GFFStruct &GFFFile::getStruct(uint32 i) const {
 	assert(i < _structs.size());
 
@@ -144,21 +196,119 @@ const GFFList &GFFFile::getList(uint32 i, uint32 &size) const {
 	return _lists[i];
 }
 
-void GFFFile::readStructs() {
+uint32 GFFFile::getLabel(const Common::UString &label) const {
+	LabelMap::const_iterator l = _labels.find(label);
+	if (l == _labels.end())
+		return kNoLabel;
+
+	return l->second;
+}
+
+void GFFFile::readLabels(Common::SeekableReadStream &gff, std::vector<uint32> &labels) {
+	// Each label is a 16 byte, zero-padded string
+	std::vector<byte> table;
+	readTable(gff, _header.labelOffset, _header.labelCount, 16, table);
+
+	labels.resize(_header.labelCount);
+
+	LabelTable &labelTable = getLabelTable();
+	Common::StackLock lock(labelTable.mutex);
+
+	for (uint32 i = 0; i < _header.labelCount; i++) {
+		const char *name = (const char *) &table[i * 16];
+
+		Common::UString label(name, getPaddedLength(name, 16));
+
+		labels[i] = labelTable.intern(label);
+
+		_labels.insert(std::make_pair(label, labels[i]));
+	}
+}
+
+void GFFFile::readStructs(Common::SeekableReadStream &gff, const std::vector<uint32> &labels) {
+	// Read the struct array, the field array and the field indices array in one go each
+	std::vector<byte> structTable, fieldTable, indexTable;
+
+	readTable(gff, _header.structOffset, _header.structCount, 12, structTable);
+	readTable(gff, _header.fieldOffset , _header.fieldCount , 12, fieldTable);
+	readTable(gff, _header.fieldIndicesOffset, _header.fieldIndicesCount, 1, indexTable);
+
 	_structs.reserve(_header.structCount);
-	for (uint32 i = 0; i < _header.structCount; i++)
-		_structs.push_back(new GFFStruct(*this, *_stream));
+	_fields.reserve(_header.fieldCount);
+
+	for (uint32 i = 0; i < _header.structCount; i++) {
+		const byte *strct = &structTable[i * 12];
+
+		const uint32 id         = READ_LE_UINT32(strct + 0);
+		const uint32 fieldIndex = READ_LE_UINT32(strct + 4);
+		const uint32 fieldCount = READ_LE_UINT32(strct + 8);
+
+		const uint32 fieldStart = _fields.size();
+
+		// A struct with exactly one field directly references that field.
+		// Otherwise, the index is a byte offset into the field indices array.
+
+		if (fieldCount == 1) {
+
+			readField(fieldTable, labels, fieldIndex);
+
+		} else if (fieldCount > 1) {
+
+			if ((fieldIndex > indexTable.size()) || (fieldCount > ((indexTable.size() - fieldIndex) / 4)))
+				throw Common::Exception("Field indices index out of range (%d+%d/%d)",
+				                        fieldIndex, fieldCount, (int) indexTable.size());
+
+			const byte *indices = &indexTable[fieldIndex];
+			for (uint32 j = 0; j < fieldCount; j++)
+				readField(fieldTable, labels, READ_LE_UINT32(indices + j * 4));
+
+		}
+
+		// Sort the fields by label, so that they can be found with a binary search
+		FieldArray::iterator begin = _fields.begin() + fieldStart;
+		std::stable_sort(begin, _fields.end());
+
+		// When a label occurs twice, the later field wins
+		FieldArray::iterator end = begin;
+		for (FieldArray::iterator f = begin; f != _fields.end(); ++f) {
+			if ((end != begin) && ((end - 1)->label == f->label))
+				*(end - 1) = *f;
+			else
+				*end++ = *f;
+		}
+		_fields.erase(end, _fields.end());
+
+		_structs.push_back(new GFFStruct(*this, id, fieldStart, _fields.size() - fieldStart));
+	}
 }
 
-void GFFFile::readLists() {
-	if (!_stream->seek(_header.listIndicesOffset))
-		throw Common::Exception(Common::kSeekError);
+void GFFFile::readField(const std::vector<byte> &fieldTable,
+                        const std::vector<uint32> &labels, uint32 index) {
+
+	if (index >= _header.fieldCount)
+		throw Common::Exception("Field index out of range (%d/%d)", index, _header.fieldCount);
+
+	const byte *field = &fieldTable[index * 12];
 
+	const uint32 type  = READ_LE_UINT32(field + 0);
+	const uint32 label = READ_LE_UINT32(field + 4);
+	const uint32 data  = READ_LE_UINT32(field + 8);
+
+	if (label >= labels.size())
+		throw Common::Exception("Label index out of range (%d/%d)", label, (int) labels.size());
+
+	_fields.push_back(GFFStruct::Field(labels[label], (GFFStruct::FieldType) type, data));
+}
+
+void GFFFile::readLists(Common::SeekableReadStream &gff) {
 	// Read list array
+	std::vector<byte> table;
+	readTable(gff, _header.listIndicesOffset, _header.listIndicesCount / 4, 4, table);
+
 	std::vector<uint32> rawLists;
 	rawLists.resize(_header.listIndicesCount / 4);
-	for (std::vector<uint32>::iterator it = rawLists.begin(); it != rawLists.end(); ++it)
-		*it = _stream->readUint32LE();
+	for (uint32 i = 0; i < rawLists.size(); i++)
+		rawLists[i] = READ_LE_UINT32(&table[i * 4]);
 
 	// Counting the actual amount of lists
 	uint32 listCount = 0;
@@ -172,6 +322,10 @@ void GFFFile::readLists() {
 		listCount++;
 	}
 
+	_lists.reserve(listCount);
+	_listSizes.reserve(listCount);
+	_listOffsetToIndex.reserve(rawLists.size());
+
 	// Converting the raw list array into real, useable lists
 	for (std::vector<uint32>::iterator it = rawLists.begin(); it != rawLists.end(); ) {
 		_listOffsetToIndex.push_back(_lists.size());
@@ -186,6 +340,9 @@ void GFFFile::readLists() {
 		for (uint32 j = 0; j < n; j++, ++it) {
 			assert(it != rawLists.end());
 
+			if (*it >= _structs.size())
+				throw Common::Exception("List struct index out of range (%d/%d)", *it, (int) _structs.size());
+
 			list.push_back(_structs[*it]);
 			size++;
 			_listOffsetToIndex.push_back(0xFFFFFFFF);
@@ -194,21 +351,29 @@ void GFFFile::readLists() {
 
 }
 
-Common::SeekableReadStream &GFFFile::getStream() const {
-	return *_stream;
+const byte *GFFFile::getFieldData(uint32 offset, uint32 size) const {
+	if (((uint64) offset + size) > _fieldData.size())
+		throw Common::Exception("Field data out of range (%u+%u/%u)", offset, size, (uint32) _fieldData.size());
+
+	if (_fieldData.empty())
+		return 0;
+
+	return &_fieldData[0] + offset;
 }
 
-Common::SeekableReadStream &GFFFile::getFieldData() const {
-	_stream->seek(_header.fieldDataOffset);
 
-	return *_stream;
+GFFFieldID::GFFFieldID(const Common::UString &label) {
+	LabelTable &labelTable = getLabelTable();
+	Common::StackLock lock(labelTable.mutex);
+
+	_id = labelTable.intern(label);
 }
 
 
-GFFStruct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFFStruct::Field::Field() : label(kNoLabel), type(kFieldTypeNone), data(0), extended(false) {
 }
 
-GFFStruct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFFStruct::Field::Field(uint32 l, FieldType t, uint32 d) : label(l), type(t), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -221,118 +386,197 @@ GFFStruct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
 	           (type == kFieldTypeVector     );
 }
 
+bool GFFStruct::Field::operator<(const Field &right) const {
+	return label < right.label;
+}
+
 
-GFFStruct::GFFStruct(const GFFFile &parent, Common::SeekableReadStream &gff) :
-	_parent(&parent) {
+GFFStruct::GFFStruct(const GFFFile &parent, uint32 id, uint32 fieldStart, uint32 fieldCount) :
+	_parent(&parent), _id(id), _fieldStart(fieldStart), _fieldCount(fieldCount) {
 
-	_id         = gff.readUint32LE();
-	_fieldIndex = gff.readUint32LE();
-	_fieldCount = gff.readUint32LE();
 }
 
 GFFStruct::~GFFStruct() {
 }
 
-void GFFStruct::load() const {
-	if (!_fields.empty())
-		return;
+const byte *GFFStruct::getData(const Field &field, uint32 offset, uint32 size) const {
+	assert(field.extended);
+
+	if (((uint64) field.data + offset) > 0xFFFFFFFF)
+		throw Common::Exception("Field data out of range");
+
+	return _parent->getFieldData(field.data + offset, size);
+}
 
-	Common::SeekableReadStream &gff = _parent->getStream();
+const GFFStruct::Field *GFFStruct::getField(const Common::UString &name) const {
+	return getField(_parent->getLabel(name));
+}
 
-	// Read the field(s)
-	if      (_fieldCount == 1)
-		readField (gff, _fieldIndex);
-	else if (_fieldCount > 1)
-		readFields(gff, _fieldIndex, _fieldCount);
+const GFFStruct::Field *GFFStruct::getField(const GFFFieldID &field) const {
+	return getField(field._id);
 }
 
-void GFFStruct::readField(Common::SeekableReadStream &gff, uint32 index) const {
-	// Sanity check
-	if (index > _parent->_header.fieldCount)
-		throw Common::Exception("Field index out of range (%d/%d)",
-				index, _parent->_header.fieldCount);
+const GFFStruct::Field *GFFStruct::getField(uint32 label) const {
+	if ((label == kNoLabel) || (_fieldCount == 0))
+		return 0;
 
-	// Seek
-	if (!gff.seek(_parent->_header.fieldOffset + index * 12))
-		throw Common::Exception(Common::kSeekError);
+	const Field *begin = &_parent->_fields[_fieldStart];
+	const Field *end   = begin + _fieldCount;
 
-	// Read the field data
-	uint32 type  = gff.readUint32LE();
-	uint32 label = gff.readUint32LE();
-	uint32 data  = gff.readUint32LE();
+	const Field *field = std::lower_bound(begin, end, Field(label, kFieldTypeNone, 0));
+	if ((field == end) || (field->label != label))
+		return 0;
 
-	// And add it to the map
-	_fields[readLabel(gff, label)] = Field((FieldType) type, data);
+	return field;
 }
 
-void GFFStruct::readFields(Common::SeekableReadStream &gff,
-                           uint32 index, uint32 count) const {
-	// Sanity check
-	if (index > _parent->_header.fieldIndicesCount)
-		throw Common::Exception("Field indices index out of range (%d/%d)",
-		                        index , _parent->_header.fieldIndicesCount);
+uint GFFStruct::getFieldCount() const {
+	return _fieldCount;
+}
 
-	// Seek
-	if (!gff.seek(_parent->_header.fieldIndicesOffset + index))
-		throw Common::Exception(Common::kSeekError);
+bool GFFStruct::hasField(const Common::UString &field) const {
+	return getField(field) != 0;
+}
 
-	// Read the field indices
-	std::vector<uint32> indices;
-	readIndices(gff, indices, count);
+bool GFFStruct::hasField(const GFFFieldID &field) const {
+	return getField(field) != 0;
+}
 
-	// Read the fields
-	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
-		readField(gff, *i);
+char GFFStruct::getChar(const Common::UString &field, char def) const {
+	return getChar(getField(field), def);
 }
 
-void GFFStruct::readIndices(Common::SeekableReadStream &gff,
-                            std::vector<uint32> &indices, uint32 count) const {
-	indices.reserve(count);
-	while (count-- > 0)
-		indices.push_back(gff.readUint32LE());
+char GFFStruct::getChar(const GFFFieldID &field, char def) const {
+	return getChar(getField(field), def);
 }
 
-Common::UString GFFStruct::readLabel(Common::SeekableReadStream &gff, uint32 index) const {
-	gff.seek(_parent->_header.labelOffset + index * 16);
+uint64 GFFStruct::getUint(const Common::UString &field, uint64 def) const {
+	return getUint(getField(field), def);
+}
 
-	Common::UString label;
-	label.readFixedASCII(gff, 16);
+uint64 GFFStruct::getUint(const GFFFieldID &field, uint64 def) const {
+	return getUint(getField(field), def);
+}
 
-	return label;
+int64 GFFStruct::getSint(const Common::UString &field, int64 def) const {
+	return getSint(getField(field), def);
 }
 
-Common::SeekableReadStream &GFFStruct::getData(const Field &field) const {
-	assert(field.extended);
+int64 GFFStruct::getSint(const GFFFieldID &field, int64 def) const {
+	return getSint(getField(field), def);
+}
 
-	Common::SeekableReadStream &data = _parent->getFieldData();
+bool GFFStruct::getBool(const Common::UString &field, bool def) const {
+	return getUint(getField(field), def) != 0;
+}
 
-	data.seek(field.data, SEEK_CUR);
+bool GFFStruct::getBool(const GFFFieldID &field, bool def) const {
+	return getUint(getField(field), def) != 0;
+}
 
-	return data;
+double GFFStruct::getDouble(const Common::UString &field, double def) const {
+	return getDouble(getField(field), def);
 }
 
-const GFFStruct::Field *GFFStruct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
-		return 0;
+double GFFStruct::getDouble(const GFFFieldID &field, double def) const {
+	return getDouble(getField(field), def);
+}
 
-	return &field->second;
+Common::UString GFFStruct::getString(const Common::UString &field,
+                                        const Common::UString &def) const {
+	return getString(getField(field), def);
 }
 
-uint GFFStruct::getFieldCount() const {
-	return _fields.size();
+Common::UString GFFStruct::getString(const GFFFieldID &field,
+                                        const Common::UString &def) const {
+	return getString(getField(field), def);
 }
 
-bool GFFStruct::hasField(const Common::UString &field) const {
-	load();
+void GFFStruct::getLocString(const Common::UString &field, LocString &str) const {
+	getLocString(getField(field), str);
+}
 
-	return getField(field) != 0;
+void GFFStruct::getLocString(const GFFFieldID &field, LocString &str) const {
+	getLocString(getField(field), str);
 }
 
-char GFFStruct::getChar(const Common::UString &field, char def) const {
-	load();
+Common::SeekableReadStream *GFFStruct::getData(const Common::UString &field) const {
+	return getData(getField(field));
+}
+
+Common::SeekableReadStream *GFFStruct::getData(const GFFFieldID &field) const {
+	return getData(getField(field));
+}
+
+void GFFStruct::getVector(const Common::UString &field,
+                          float &x, float &y, float &z) const {
+	getVector(getField(field), x, y, z);
+}
+
+void GFFStruct::getVector(const GFFFieldID &field,
+                          float &x, float &y, float &z) const {
+	getVector(getField(field), x, y, z);
+}
+
+void GFFStruct::getOrientation(const Common::UString &field,
+                               float &a, float &b, float &c, float &d) const {
+	getOrientation(getField(field), a, b, c, d);
+}
+
+void GFFStruct::getOrientation(const GFFFieldID &field,
+                               float &a, float &b, float &c, float &d) const {
+	getOrientation(getField(field), a, b, c, d);
+}
+
+void GFFStruct::getVector(const Common::UString &field,
+                          double &x, double &y, double &z) const {
+	getVector(getField(field), x, y, z);
+}
+
+void GFFStruct::getVector(const GFFFieldID &field,
+                          double &x, double &y, double &z) const {
+	getVector(getField(field), x, y, z);
+}
+
+void GFFStruct::getOrientation(const Common::UString &field,
+                               double &a, double &b, double &c, double &d) const {
+	getOrientation(getField(field), a, b, c, d);
+}
+
+void GFFStruct::getOrientation(const GFFFieldID &field,
+                               double &a, double &b, double &c, double &d) const {
+	getOrientation(getField(field), a, b, c, d);
+}
+
+const GFFStruct &GFFStruct::getStruct(const Common::UString &field) const {
+	return getStruct(getField(field));
+}
+
+const GFFStruct &GFFStruct::getStruct(const GFFFieldID &field) const {
+	return getStruct(getField(field));
+}
+
+const GFFList &GFFStruct::getList(const Common::UString &field, uint32 &size) const {
+	return getList(getField(field), size);
+}
+
+const GFFList &GFFStruct::getList(const GFFFieldID &field, uint32 &size) const {
+	return getList(getField(field), size);
+}
+
+const GFFList &GFFStruct::getList(const Common::UString &field) const {
+	uint32 size;
+
+	return getList(getField(field), size);
+}
+
+const GFFList &GFFStruct::getList(const GFFFieldID &field) const {
+	uint32 size;
+
+	return getList(getField(field), size);
+}
 
-	const Field *f = getField(field);
+char GFFStruct::getChar(const Field *f, char def) const {
 	if (!f)
 		return def;
 	if (f->type != kFieldTypeChar)
@@ -341,10 +585,7 @@ char GFFStruct::getChar(const Common::UString &field, char def) const {
 	return (char) f->data;
 }
 
-uint64 GFFStruct::getUint(const Common::UString &field, uint64 def) const {
-	load();
-
-	const Field *f = getField(field);
+uint64 GFFStruct::getUint(const Field *f, uint64 def) const {
 	if (!f)
 		return def;
 
@@ -362,17 +603,14 @@ uint64 GFFStruct::getUint(const Common::UString &field, uint64 def) const {
 	if (f->type == kFieldTypeSint32)
 		return (uint64) ((int64) ((int32) ((uint32) f->data)));
 	if (f->type == kFieldTypeUint64)
-		return (uint64) getData(*f).readUint64LE();
+		return (uint64) READ_LE_UINT64(getData(*f, 0, 8));
 	if (f->type == kFieldTypeSint64)
-		return ( int64) getData(*f).readUint64LE();
+		return ( int64) READ_LE_UINT64(getData(*f, 0, 8));
 
 	throw Common::Exception("Field is not an int type");
 }
 
-int64 GFFStruct::getSint(const Common::UString &field, int64 def) const {
-	load();
-
-	const Field *f = getField(field);
+int64 GFFStruct::getSint(const Field *f, int64 def) const {
 	if (!f)
 		return def;
 
@@ -390,46 +628,33 @@ int64 GFFStruct::getSint(const Common::UString &field, int64 def) const {
 	if (f->type == kFieldTypeSint32)
 		return (int64) ((int32) ((uint32) f->data));
 	if (f->type == kFieldTypeUint64)
-		return (int64) getData(*f).readUint64LE();
+		return (int64) READ_LE_UINT64(getData(*f, 0, 8));
 	if (f->type == kFieldTypeSint64)
-		return (int64) getData(*f).readUint64LE();
+		return (int64) READ_LE_UINT64(getData(*f, 0, 8));
 
 	throw Common::Exception("Field is not an int type");
 }
 
-bool GFFStruct::getBool(const Common::UString &field, bool def) const {
-	load();
-
-	return getUint(field, def) != 0;
-}
-
-double GFFStruct::getDouble(const Common::UString &field, double def) const {
-	load();
-
-	const Field *f = getField(field);
+double GFFStruct::getDouble(const Field *f, double def) const {
 	if (!f)
 		return def;
 
 	if (f->type == kFieldTypeFloat)
 		return convertIEEEFloat(f->data);
 	if (f->type == kFieldTypeDouble)
-		return getData(*f).readIEEEDoubleLE();
+		return convertIEEEDouble(READ_LE_UINT64(getData(*f, 0, 8)));
 
 	throw Common::Exception("Field is not a double type");
 }
 
-Common::UString GFFStruct::getString(const Common::UString &field,
-                                        const Common::UString &def) const {
-	load();
-
-	const Field *f = getField(field);
+Common::UString GFFStruct::getString(const Field *f, const Common::UString &def) const {
 	if (!f)
 		return def;
 
 	if (f->type == kFieldTypeExoString) {
-		Common::SeekableReadStream &data = getData(*f);
+		uint32 length = READ_LE_UINT32(getData(*f, 0, 4));
 
-		uint32 length = data.readUint32LE();
+		Common::MemoryReadStream data(getData(*f, 4, length), length);
 
 		Common::UString str;
 		str.readFixedASCII(data, length);
@@ -437,9 +662,9 @@ Common::UString GFFStruct::getString(const Common::UString &field,
 	}
 
 	if (f->type == kFieldTypeResRef) {
-		Common::SeekableReadStream &data = getData(*f);
+		uint32 length = *getData(*f, 0, 1);
 
-		uint32 length = data.readByte();
+		Common::MemoryReadStream data(getData(*f, 1, length), length);
 
 		Common::UString str;
 		str.readFixedASCII(data, length);
@@ -451,7 +676,7 @@ Common::UString GFFStruct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeUint32) ||
 	    (f->type == kFieldTypeUint64)) {
 
-		return Common::UString::sprintf("%lu", getUint(field));
+		return Common::UString::sprintf("%lu", getUint(f, 0));
 	}
 
 	if ((f->type == kFieldTypeChar  ) ||
@@ -459,140 +684,117 @@ Common::UString GFFStruct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeSint32) ||
 	    (f->type == kFieldTypeSint64)) {
 
-		return Common::UString::sprintf("%ld", getSint(field));
+		return Common::UString::sprintf("%ld", getSint(f, 0));
 	}
 
 	if ((f->type == kFieldTypeFloat) ||
 	    (f->type == kFieldTypeDouble)) {
 
-		return Common::UString::sprintf("%lf", getDouble(field));
+		return Common::UString::sprintf("%lf", getDouble(f, 0.0));
 	}
 
 	if (f->type == kFieldTypeVector) {
 		float x, y, z;
 
-		getVector(field, x, y, z);
+		getVector(f, x, y, z);
 		return Common::UString::sprintf("%f/%f/%f", x, y, z);
 	}
 
 	if (f->type == kFieldTypeOrientation) {
 		float a, b, c, d;
 
-		getOrientation(field, a, b, c, d);
+		getOrientation(f, a, b, c, d);
 		return Common::UString::sprintf("%f/%f/%f/%f", a, b, c, d);
 	}
 
 	throw Common::Exception("Field is not a string(able) type");
 }
 
-void GFFStruct::getLocString(const Common::UString &field, LocString &str) const {
-	load();
-
-	const Field *f = getField(field);
+void GFFStruct::getLocString(const Field *f, LocString &str) const {
 	if (!f)
 		return;
 	if (f->type != kFieldTypeLocString)
 		throw Common::Exception("Field is not of a localized string type");
 
-	Common::SeekableReadStream &data = getData(*f);
-
-	uint32 size = data.readUint32LE();
+	uint32 size = READ_LE_UINT32(getData(*f, 0, 4));
 
-	Common::SeekableSubReadStream gff(&data, data.pos(), data.pos() + size);
+	Common::MemoryReadStream gff(getData(*f, 4, size), size);
 
 	str.readLocString(gff);
 }
 
-Common::SeekableReadStream *GFFStruct::getData(const Common::UString &field) const {
-	load();
-
-	const Field *f = getField(field);
+Common::SeekableReadStream *GFFStruct::getData(const Field *f) const {
 	if (!f)
 		return 0;
 	if (f->type != kFieldTypeVoid)
 		throw Common::Exception("Field is not a data type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	uint32 size = READ_LE_UINT32(getData(*f, 0, 4));
 
-	uint32 size = data.readUint32LE();
+	Common::MemoryReadStream data(getData(*f, 4, size), size);
 
 	return data.readStream(size);
 }
 
-void GFFStruct::getVector(const Common::UString &field,
+void GFFStruct::getVector(const Field *f,
                           float &x, float &y, float &z) const {
-	load();
-
-	const Field *f = getField(field);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeVector)
 		throw Common::Exception("Field is not a vector type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getData(*f, 0, 12);
 
-	x = data.readIEEEFloatLE();
-	y = data.readIEEEFloatLE();
-	z = data.readIEEEFloatLE();
+	x = convertIEEEFloat(READ_LE_UINT32(data + 0));
+	y = convertIEEEFloat(READ_LE_UINT32(data + 4));
+	z = convertIEEEFloat(READ_LE_UINT32(data + 8));
 }
 
-void GFFStruct::getOrientation(const Common::UString &field,
+void GFFStruct::getOrientation(const Field *f,
                                float &a, float &b, float &c, float &d) const {
-	load();
-
-	const Field *f = getField(field);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeOrientation)
 		throw Common::Exception("Field is not an orientation type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getData(*f, 0, 16);
 
-	a = data.readIEEEFloatLE();
-	b = data.readIEEEFloatLE();
-	c = data.readIEEEFloatLE();
-	d = data.readIEEEFloatLE();
+	a = convertIEEEFloat(READ_LE_UINT32(data +  0));
+	b = convertIEEEFloat(READ_LE_UINT32(data +  4));
+	c = convertIEEEFloat(READ_LE_UINT32(data +  8));
+	d = convertIEEEFloat(READ_LE_UINT32(data + 12));
 }
 
-void GFFStruct::getVector(const Common::UString &field,
+void GFFStruct::getVector(const Field *f,
                           double &x, double &y, double &z) const {
-	load();
-
-	const Field *f = getField(field);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeVector)
 		throw Common::Exception("Field is not a vector type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getData(*f, 0, 12);
 
-	x = data.readIEEEFloatLE();
-	y = data.readIEEEFloatLE();
-	z = data.readIEEEFloatLE();
+	x = convertIEEEFloat(READ_LE_UINT32(data + 0));
+	y = convertIEEEFloat(READ_LE_UINT32(data + 4));
+	z = convertIEEEFloat(READ_LE_UINT32(data + 8));
 }
 
-void GFFStruct::getOrientation(const Common::UString &field,
+void GFFStruct::getOrientation(const Field *f,
                                double &a, double &b, double &c, double &d) const {
-	load();
-
-	const Field *f = getField(field);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeOrientation)
 		throw Common::Exception("Field is not an orientation type");
 
-	Common::SeekableReadStream &data = getData(*f);
+	const byte *data = getData(*f, 0, 16);
 
-	a = data.readIEEEFloatLE();
-	b = data.readIEEEFloatLE();
-	c = data.readIEEEFloatLE();
-	d = data.readIEEEFloatLE();
+	a = convertIEEEFloat(READ_LE_UINT32(data +  0));
+	b = convertIEEEFloat(READ_LE_UINT32(data +  4));
+	c = convertIEEEFloat(READ_LE_UINT32(data +  8));
+	d = convertIEEEFloat(READ_LE_UINT32(data + 12));
 }
 
-const GFFStruct &GFFStruct::getStruct(const Common::UString &field) const {
-	load();
-
-	const Field *f = getField(field);
+const GFFStruct &GFFStruct::getStruct(const Field *f) const {
 	if (!f)
 		throw Common::Exception("No such field");
 	if (f->type != kFieldTypeStruct)
@@ -602,10 +804,7 @@ const GFFStruct &GFFStruct::getStruct(const Common::UString &field) const {
 	return _parent->getStruct(f->data);
 }
 
-const GFFList &GFFStruct::getList(const Common::UString &field, uint32 &size) const {
-	load();
-
-	const Field *f = getField(field);
+const GFFList &GFFStruct::getList(const Field *f, uint32 &size) const {
 	if (!f)
 		throw Common::Exception("No such field");
 	if (f->type != kFieldTypeList)
@@ -615,10 +814,4 @@ const GFFList &GFFStruct::getList(const Common::UString &field, uint32 &size) co
 	return _parent->getList(f->data / 4, size);
 }
 
-const GFFList &GFFStruct::getList(const Common::UString &field) const {
-	uint32 size;
-
-	return getList(field, size);
-}
-
 } // End of namespace Aurora
@@ -32,7 +32,8 @@
 
 #include <vector>
 #include <list>
-#include <map>
+
+#include <boost/unordered/unordered_map.hpp>
 
 #include "common/types.h"
 #include "common/ustring.h"
@@ -47,76 +48,24 @@ namespace Common {
 namespace Aurora {
 
 class LocString;
+class GFFFile;
 class GFFStruct;
 
 typedef std::list<GFFStruct *> GFFList;
 
-class GFFFile : public AuroraBase {
+/** A pre-resolved GFF field label.
+ *
+ *  Looking up a field by its label string means hashing that string
+ *  first. Code that looks up the same fields over and over, like the
+ *  loaders of game objects, can instead resolve each label once into
+ *  a (usually static) GFFFieldID, and then use that for the lookups.
+ */
+class GFFFieldID {
 public:
-	GFFFile(Common::SeekableReadStream *gff, uint32 id);
-	GFFFile(const Common::UString &gff, FileType type, uint32 id);
-	~GFFFile();
-
-	/** Returns the top-level struct. */
-	const GFFStruct &getTopLevel() const;
+	explicit GFFFieldID(const Common::UString &label);
 
 private:
-	/** A GFF header. */
-	struct Header {
-		uint32 structOffset;
-		uint32 structCount;
-		uint32 fieldOffset;
-		uint32 fieldCount;
-		uint32 labelOffset;
-		uint32 labelCount;
-		uint32 fieldDataOffset;
-		uint32 fieldDataCount;
-		uint32 fieldIndicesOffset;
-		uint32 fieldIndicesCount;
-		uint32 listIndicesOffset;
-		uint32 listIndicesCount;
-
-		Header();
-
-		/** Clear the header. */
-		void clear();
-
-		/** Read the header out of a gff. */
-		void read(Common::SeekableReadStream &gff);
-	};
-
-	typedef std::vector<GFFStruct *> StructArray;
-	typedef std::vector<GFFList> ListArray;
-
-
-	Common::SeekableReadStream *_stream;
-
-	Header _header; ///< The GFF's header
-
-	StructArray _structs; ///< Our structs.
-	ListArray   _lists;   ///< Our lists.
-
-	/** The size of each GFF list. */
-	std::vector<uint32> _listSizes;
-
-	/** To convert list offsets found in GFF to real indices. */
-	std::vector<uint32> _listOffsetToIndex;
-
-
-	/** Return the GFF stream. */
-	Common::SeekableReadStream &getStream() const;
-	/** Return the GFF stream seeked to the start of the field data. */
-	Common::SeekableReadStream &getFieldData() const;
-
-	/** Return a struct within the GFF. */
-	const GFFStruct &getStruct(uint32 i) const;
-	/** Return a list within the GFF. */
-	const GFFList   &getList  (uint32 i, uint32 &size) const;
-
-	// Loading helpers
-	void load(uint32 id);
-	void readStructs();
-	void readLists();
+	uint32 _id; ///< The ID of the label.
 
 	friend class GFFStruct;
 };
@@ -124,6 +73,30 @@ private:
 /** A struct within a GFF. */
 class GFFStruct {
 public:
+	/** The type of a GFF field. */
+	enum FieldType {
+		kFieldTypeNone        = - 1, ///< Invalid type.
+		kFieldTypeByte        =   0, ///< A single byte.
+		kFieldTypeChar        =   1, ///< A single character.
+		kFieldTypeUint16      =   2, ///< Unsigned 16bit integer.
+		kFieldTypeSint16      =   3, ///< Signed 16bit integer.
+		kFieldTypeUint32      =   4, ///< Unsigned 32bit integer.
+		kFieldTypeSint32      =   5, ///< Signed 32bit integer.
+		kFieldTypeUint64      =   6, ///< Unsigned 64bit integer.
+		kFieldTypeSint64      =   7, ///< Signed 64bit integer.
+		kFieldTypeFloat       =   8, ///< IEEE float.
+		kFieldTypeDouble      =   9, ///< IEEE double.
+		kFieldTypeExoString   =  10, ///< String.
+		kFieldTypeResRef      =  11, ///< String, max. 16 characters.
+		kFieldTypeLocString   =  12, ///< Localized string.
+		kFieldTypeVoid        =  13, ///< Random data of variable length.
+		kFieldTypeStruct      =  14, ///< Struct containing a number of fields.
+		kFieldTypeList        =  15, ///< List containing a number of structs.
+		kFieldTypeOrientation =  16, ///< An object orientation.
+		kFieldTypeVector      =  17, ///< A vector of 3 floats.
+		kFieldTypeStrRef      =  18  // TODO: New in Jade Empire
+	};
+
 	uint getFieldCount() const;
 
 	bool hasField(const Common::UString &field) const;
@@ -156,71 +129,188 @@ public:
 	const GFFList   &getList  (const Common::UString &field) const;
 	const GFFList   &getList  (const Common::UString &field, uint32 &size) const;
 
-private:
-	/** The type of a GFF field. */
-	enum FieldType {
-		kFieldTypeNone        = - 1, ///< Invalid type.
-		kFieldTypeByte        =   0, ///< A single byte.
-		kFieldTypeChar        =   1, ///< A single character.
-		kFieldTypeUint16      =   2, ///< Unsigned 16bit integer.
-		kFieldTypeSint16      =   3, ///< Signed 16bit integer.
-		kFieldTypeUint32      =   4, ///< Unsigned 32bit integer.
-		kFieldTypeSint32      =   5, ///< Signed 32bit integer.
-		kFieldTypeUint64      =   6, ///< Unsigned 64bit integer.
-		kFieldTypeSint64      =   7, ///< Signed 64bit integer.
-		kFieldTypeFloat       =   8, ///< IEEE float.
-		kFieldTypeDouble      =   9, ///< IEEE double.
-		kFieldTypeExoString   =  10, ///< String.
-		kFieldTypeResRef      =  11, ///< String, max. 16 characters.
-		kFieldTypeLocString   =  12, ///< Localized string.
-		kFieldTypeVoid        =  13, ///< Random data of variable length.
-		kFieldTypeStruct      =  14, ///< Struct containing a number of fields.
-		kFieldTypeList        =  15, ///< List containing a number of structs.
-		kFieldTypeOrientation =  16, ///< An object orientation.
-		kFieldTypeVector      =  17, ///< A vector of 3 floats.
-		kFieldTypeStrRef      =  18  // TODO: New in Jade Empire
-	};
+	// Pre-resolved field labels
+
+	bool hasField(const GFFFieldID &field) const;
+
+	char   getChar(const GFFFieldID &field, char   def = '\0' ) const;
+	uint64 getUint(const GFFFieldID &field, uint64 def = 0    ) const;
+	 int64 getSint(const GFFFieldID &field,  int64 def = 0    ) const;
+	bool   getBool(const GFFFieldID &field, bool   def = false) const;
+
+	double getDouble(const GFFFieldID &field, double def = 0.0) const;
+
+	Common::UString getString(const GFFFieldID &field,
+	                          const Common::UString &def = "") const;
+
+	void getLocString(const GFFFieldID &field, LocString &str) const;
+
+	Common::SeekableReadStream *getData(const GFFFieldID &field) const;
+
+	void getVector     (const GFFFieldID &field,
+			float &x, float &y, float &z          ) const;
+	void getOrientation(const GFFFieldID &field,
+			float &a, float &b, float &c, float &d) const;
+
+	void getVector     (const GFFFieldID &field,
+			double &x, double &y, double &z           ) const;
+	void getOrientation(const GFFFieldID &field,
+			double &a, double &b, double &c, double &d) const;
 
+	const GFFStruct &getStruct(const GFFFieldID &field) const;
+	const GFFList   &getList  (const GFFFieldID &field) const;
+	const GFFList   &getList  (const GFFFieldID &field, uint32 &size) const;
+
+private:
 	/** A GFF field. */
 	struct Field {
+		uint32    label;    ///< ID of the field's label.
 		FieldType type;     ///< Type of the field.
 		uint32    data;     ///< Data of the field.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32 d);
-	};
+		Field(uint32 l, FieldType t, uint32 d);
 
-	typedef std::map<Common::UString, Field> FieldMap;
+		bool operator<(const Field &right) const;
+	};
 
 	const GFFFile *_parent; ///< The parent GFF.
 
 	uint32 _id;         ///< The struct's ID.
-	uint32 _fieldIndex; ///< Field / Field indices index.
+	uint32 _fieldStart; ///< Index of the struct's first field in the GFF's field array.
 	uint32 _fieldCount; ///< Field count.
 
-	mutable FieldMap _fields; ///< The fields, indexed by their label.
-
-	GFFStruct(const GFFFile &parent, Common::SeekableReadStream &gff);
+	GFFStruct(const GFFFile &parent, uint32 id, uint32 fieldStart, uint32 fieldCount);
 	~GFFStruct();
 
-	void load() const;
-
 	/** Returns the field with this tag. */
 	const Field *getField(const Common::UString &name) const;
-	/** Returns the extended field data for this field. */
-	Common::SeekableReadStream &getData(const Field &field) const;
+	/** Returns the field with this pre-resolved tag. */
+	const Field *getField(const GFFFieldID &field) const;
+	/** Returns the field with this label ID. */
+	const Field *getField(uint32 label) const;
+	/** Returns size bytes of the extended field data for this field, starting at offset. */
+	const byte *getData(const Field &field, uint32 offset, uint32 size) const;
 
-	// Loading helpers
-	void readField  (Common::SeekableReadStream &gff, uint32 index) const;
-	void readFields (Common::SeekableReadStream &gff, uint32 index, uint32 count) const;
-	void readIndices(Common::SeekableReadStream &gff,
-	                 std::vector<uint32> &indices, uint32 count) const;
-	Common::UString readLabel(Common::SeekableReadStream &gff, uint32 index) const;
+	// Accessors for fields that have already been looked up
+	char   getChar(const Field *f, char   def) const;
+	uint64 getUint(const Field *f, uint64 def) const;
+	 int64 getSint(const Field *f,  int64 def) const;
+
+	double getDouble(const Field *f, double def) const;
+
+	Common::UString getString(const Field *f, const Common::UString &def) const;
+
+	void getLocString(const Field *f, LocString &str) const;
+
+	Common::SeekableReadStream *getData(const Field *f) const;
+
+	void getVector     (const Field *f, float &x, float &y, float &z) const;
+	void getOrientation(const Field *f, float &a, float &b, float &c, float &d) const;
+
+	void getVector     (const Field *f, double &x, double &y, double &z) const;
+	void getOrientation(const Field *f, double &a, double &b, double &c, double &d) const;
+
+	const GFFStruct &getStruct(const Field *f) const;
+	const GFFList   &getList  (const Field *f, uint32 &size) const;
 
 	friend class GFFFile;
 };
 
+
+/** A GFF file.
+ *
+ *  The whole GFF is decoded when it's loaded, and it's never changed
+ *  afterwards. All accessors of the GFF and its structs are therefore
+ *  pure reads, and can safely be used from several threads at once.
+ */
+class GFFFile : public AuroraBase {
+public:
+	GFFFile(Common::SeekableReadStream *gff, uint32 id);
+	GFFFile(const Common::UString &gff, FileType type, uint32 id);
+	~GFFFile();
+
+	/** Returns the top-level struct. */
+	const GFFStruct &getTopLevel() const;
+
+	/** Add the strRefs of all localized string fields in this GFF to the list. */
+	void getStrRefs(std::vector<uint32> &strRefs) const;
+
+private:
+	/** A GFF header. */
+	struct Header {
+		uint32 structOffset;
+		uint32 structCount;
+		uint32 fieldOffset;
+		uint32 fieldCount;
+		uint32 labelOffset;
+		uint32 labelCount;
+		uint32 fieldDataOffset;
+		uint32 fieldDataCount;
+		uint32 fieldIndicesOffset;
+		uint32 fieldIndicesCount;
+		uint32 listIndicesOffset;
+		uint32 listIndicesCount;
+
+		Header();
+
+		/** Clear the header. */
+		void clear();
+
+		/** Read the header out of a gff. */
+		void read(Common::SeekableReadStream &gff);
+	};
+
+	typedef std::vector<GFFStruct *> StructArray;
+	typedef std::vector<GFFList> ListArray;
+	typedef std::vector<GFFStruct::Field> FieldArray;
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelMap;
+
+
+	Header _header; ///< The GFF's header
+
+	StructArray _structs; ///< Our structs.
+	ListArray   _lists;   ///< Our lists.
+
+	/** The fields of all structs, grouped by struct and sorted by label ID. */
+	FieldArray _fields;
+
+	/** The IDs of the labels used within this GFF. */
+	LabelMap _labels;
+
+	/** The extended data of all fields. */
+	std::vector<byte> _fieldData;
+
+	/** The size of each GFF list. */
+	std::vector<uint32> _listSizes;
+
+	/** To convert list offsets found in GFF to real indices. */
+	std::vector<uint32> _listOffsetToIndex;
+
+
+	/** Return size bytes of the extended field data, starting at offset. */
+	const byte *getFieldData(uint32 offset, uint32 size) const;
+
+	/** Return a struct within the GFF. */
+	const GFFStruct &getStruct(uint32 i) const;
+	/** Return a list within the GFF. */
+	const GFFList   &getList  (uint32 i, uint32 &size) const;
+
+	/** Return the ID of a label used within this GFF, or 0xFFFFFFFF. */
+	uint32 getLabel(const Common::UString &label) const;
+
+	// Loading helpers
+	void load(Common::SeekableReadStream &gff, uint32 id);
+	void readLabels(Common::SeekableReadStream &gff, std::vector<uint32> &labels);
+	void readStructs(Common::SeekableReadStream &gff, const std::vector<uint32> &labels);
+	void readField(const std::vector<byte> &fieldTable, const std::vector<uint32> &labels, uint32 index);
+	void readLists(Common::SeekableReadStream &gff);
+
+	friend class GFFStruct;
+};
+
 } // End of namespace Aurora
 
 #endif // AURORA_GFFFILE_H
@@ -0,0 +1,479 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/gffwriter.cpp
+ *  Writing BioWare's GFFs (generic file format).
+ */
+
+#include <cstring>
+
+#include <boost/functional/hash.hpp>
+
+#include "common/endianness.h"
+#include "common/error.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+#include "aurora/gffwriter.h"
+#include "aurora/gfffile.h"
+#include "aurora/locstring.h"
+
+static const uint32 kVersion32 = MKID_BE('V3.2');
+
+static const uint32 kNone = 0xFFFFFFFF;
+
+/** Encode a string into Latin9, the encoding of localized strings in GFFs. */
+static void encodeLatin9(const Common::UString &str, std::vector<byte> &data) {
+	for (Common::UString::iterator c = str.begin(); c != str.end(); ++c) {
+		uint32 chr = *c;
+
+		// The few places where Latin9 differs from Latin1
+		switch (chr) {
+			case 0x20AC: chr = 0xA4; break;
+			case 0x0160: chr = 0xA6; break;
+			case 0x0161: chr = 0xA8; break;
+			case 0x017D: chr = 0xB4; break;
+			case 0x017E: chr = 0xB8; break;
+			case 0x0152: chr = 0xBC; break;
+			case 0x0153: chr = 0xBD; break;
+			case 0x0178: chr = 0xBE; break;
+
+			case 0xA4: case 0xA6: case 0xA8: case 0xB4:
+			case 0xB8: case 0xBC: case 0xBD: case 0xBE:
+				chr = '?';
+				break;
+
+			default:
+				if (chr > 0xFF)
+					chr = '?';
+				break;
+		}
+
+		data.push_back((byte) chr);
+	}
+}
+
+/** Write a whole table into a stream. */
+static void writeTable(Common::WriteStream &stream, const std::vector<byte> &table) {
+	if (table.empty())
+		return;
+
+	if (stream.write(&table[0], table.size()) != table.size())
+		throw Common::Exception(Common::kWriteError);
+}
+
+namespace Aurora {
+
+GFFWriter::Struct::Struct(uint32 i) : id(i), fieldCount(0),
+	firstField(kNone), lastField(kNone), next(kNone) {
+
+}
+
+GFFWriter::Field::Field(uint32 t, uint32 l, uint32 d) : type(t), label(l), data(d), next(kNone) {
+}
+
+GFFWriter::List::List() : structCount(0), firstStruct(kNone), lastStruct(kNone) {
+}
+
+
+GFFWriter::GFFWriter(uint32 id) : _id(id) {
+	// The top-level struct
+	_structs.push_back(Struct(0xFFFFFFFF));
+}
+
+GFFWriter::~GFFWriter() {
+}
+
+uint32 GFFWriter::getTopLevel() const {
+	return 0;
+}
+
+uint32 GFFWriter::getLabel(const Common::UString &label) {
+	LabelMap::const_iterator l = _labelIndices.find(label);
+	if (l != _labelIndices.end())
+		return l->second;
+
+	if (std::strlen(label.c_str()) > 16)
+		throw Common::Exception("GFF label \"%s\" is too long", label.c_str());
+
+	const uint32 index = _labels.size();
+
+	_labelIndices.insert(std::make_pair(label, index));
+	_labels.push_back(label);
+
+	return index;
+}
+
+uint32 GFFWriter::addData(const byte *data, uint32 size) {
+	const std::size_t hash = boost::hash_range(data, data + size);
+
+	// Do we already have exactly this data?
+	std::pair<DataMap::const_iterator, DataMap::const_iterator> same = _dataMap.equal_range(hash);
+	for (DataMap::const_iterator d = same.first; d != same.second; ++d)
+		if ((d->second.second == size) && !std::memcmp(&_fieldData[d->second.first], data, size))
+			return d->second.first;
+
+	const uint32 offset = _fieldData.size();
+
+	_fieldData.insert(_fieldData.end(), data, data + size);
+	_dataMap.insert(std::make_pair(hash, DataRange(offset, size)));
+
+	return offset;
+}
+
+void GFFWriter::addField(uint32 strct, const Common::UString &label, uint32 type, uint32 data) {
+	if (strct >= _structs.size())
+		throw Common::Exception("Struct index out of range (%d/%d)", strct, (int) _structs.size());
+
+	Struct &s = _structs[strct];
+
+	const uint32 labelIndex = getLabel(label);
+	for (uint32 f = s.firstField; f != kNone; f = _fields[f].next)
+		if (_fields[f].label == labelIndex)
+			throw Common::Exception("Struct %d already has a field \"%s\"", strct, label.c_str());
+
+	const uint32 index = _fields.size();
+
+	_fields.push_back(Field(type, labelIndex, data));
+
+	if (s.lastField == kNone)
+		s.firstField = index;
+	else
+		_fields[s.lastField].next = index;
+
+	s.lastField = index;
+	s.fieldCount++;
+}
+
+void GFFWriter::addExtendedField(uint32 strct, const Common::UString &label, uint32 type,
+                                 const byte *data, uint32 size) {
+
+	addField(strct, label, type, addData(data, size));
+}
+
+uint32 GFFWriter::addStruct(uint32 strct, const Common::UString &label, uint32 id) {
+	const uint32 index = _structs.size();
+
+	addField(strct, label, GFFStruct::kFieldTypeStruct, index);
+
+	_structs.push_back(Struct(id));
+
+	return index;
+}
+
+uint32 GFFWriter::addList(uint32 strct, const Common::UString &label) {
+	const uint32 index = _lists.size();
+
+	// The data will be turned into an offset into the list indices when writing
+	addField(strct, label, GFFStruct::kFieldTypeList, index);
+
+	_lists.push_back(List());
+
+	return index;
+}
+
+uint32 GFFWriter::addListStruct(uint32 list, uint32 id) {
+	if (list >= _lists.size())
+		throw Common::Exception("List index out of range (%d/%d)", list, (int) _lists.size());
+
+	const uint32 index = _structs.size();
+
+	_structs.push_back(Struct(id));
+
+	List &l = _lists[list];
+	if (l.lastStruct == kNone)
+		l.firstStruct = index;
+	else
+		_structs[l.lastStruct].next = index;
+
+	l.lastStruct = index;
+	l.structCount++;
+
+	return index;
+}
+
+void GFFWriter::addByte(uint32 strct, const Common::UString &label, uint8 value) {
+	addField(strct, label, GFFStruct::kFieldTypeByte, value);
+}
+
+void GFFWriter::addChar(uint32 strct, const Common::UString &label, char value) {
+	addField(strct, label, GFFStruct::kFieldTypeChar, (uint8) value);
+}
+
+void GFFWriter::addUint16(uint32 strct, const Common::UString &label, uint16 value) {
+	addField(strct, label, GFFStruct::kFieldTypeUint16, value);
+}
+
+void GFFWriter::addSint16(uint32 strct, const Common::UString &label, int16 value) {
+	addField(strct, label, GFFStruct::kFieldTypeSint16, (uint16) value);
+}
+
+void GFFWriter::addUint32(uint32 strct, const Common::UString &label, uint32 value) {
+	addField(strct, label, GFFStruct::kFieldTypeUint32, value);
+}
+
+void GFFWriter::addSint32(uint32 strct, const Common::UString &label, int32 value) {
+	addField(strct, label, GFFStruct::kFieldTypeSint32, (uint32) value);
+}
+
+void GFFWriter::addUint64(uint32 strct, const Common::UString &label, uint64 value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, value);
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeUint64, data, sizeof(data));
+}
+
+void GFFWriter::addSint64(uint32 strct, const Common::UString &label, int64 value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, (uint64) value);
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeSint64, data, sizeof(data));
+}
+
+void GFFWriter::addFloat(uint32 strct, const Common::UString &label, float value) {
+	addField(strct, label, GFFStruct::kFieldTypeFloat, convertIEEEFloat(value));
+}
+
+void GFFWriter::addDouble(uint32 strct, const Common::UString &label, double value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, convertIEEEDouble(value));
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeDouble, data, sizeof(data));
+}
+
+void GFFWriter::addExoString(uint32 strct, const Common::UString &label,
+                             const Common::UString &value) {
+
+	const uint32 length = std::strlen(value.c_str());
+
+	std::vector<byte> data(4 + length);
+	WRITE_LE_UINT32(&data[0], length);
+	std::memcpy(&data[4], value.c_str(), length);
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeExoString, &data[0], data.size());
+}
+
+void GFFWriter::addResRef(uint32 strct, const Common::UString &label,
+                          const Common::UString &value) {
+
+	const uint32 length = std::strlen(value.c_str());
+	if (length > 16)
+		throw Common::Exception("ResRef \"%s\" is too long", value.c_str());
+
+	byte data[17];
+	data[0] = length;
+	std::memcpy(data + 1, value.c_str(), length);
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeResRef, data, 1 + length);
+}
+
+void GFFWriter::addLocString(uint32 strct, const Common::UString &label,
+                             const LocString &value) {
+
+	// Total size, StrRef and string count, filled in below
+	std::vector<byte> data(12);
+
+	std::vector<Language> languages;
+	value.getLanguages(languages);
+
+	for (std::vector<Language>::const_iterator l = languages.begin(); l != languages.end(); ++l) {
+		const Language language = *l;
+		const uint32 start = data.size();
+
+		data.resize(start + 8);
+		encodeLatin9(value.getString(language), data);
+
+		WRITE_LE_UINT32(&data[start + 0], (uint32) language);
+		WRITE_LE_UINT32(&data[start + 4], data.size() - start - 8);
+	}
+
+	WRITE_LE_UINT32(&data[0], data.size() - 4);
+	WRITE_LE_UINT32(&data[4], value.getID());
+	WRITE_LE_UINT32(&data[8], languages.size());
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeLocString, &data[0], data.size());
+}
+
+void GFFWriter::addVoid(uint32 strct, const Common::UString &label,
+                        const byte *data, uint32 size) {
+
+	std::vector<byte> voidData(4 + size);
+	WRITE_LE_UINT32(&voidData[0], size);
+	if (size > 0)
+		std::memcpy(&voidData[4], data, size);
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeVoid, &voidData[0], voidData.size());
+}
+
+void GFFWriter::addVector(uint32 strct, const Common::UString &label,
+                          float x, float y, float z) {
+
+	byte data[12];
+	WRITE_LE_UINT32(data + 0, convertIEEEFloat(x));
+	WRITE_LE_UINT32(data + 4, convertIEEEFloat(y));
+	WRITE_LE_UINT32(data + 8, convertIEEEFloat(z));
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeVector, data, sizeof(data));
+}
+
+void GFFWriter::addOrientation(uint32 strct, const Common::UString &label,
+                               float a, float b, float c, float d) {
+
+	byte data[16];
+	WRITE_LE_UINT32(data +  0, convertIEEEFloat(a));
+	WRITE_LE_UINT32(data +  4, convertIEEEFloat(b));
+	WRITE_LE_UINT32(data +  8, convertIEEEFloat(c));
+	WRITE_LE_UINT32(data + 12, convertIEEEFloat(d));
+
+	addExtendedField(strct, label, GFFStruct::kFieldTypeOrientation, data, sizeof(data));
+}
+
+void GFFWriter::write(Common::WriteStream &stream) const {
+	// Structs with more than one field reference their field indices by byte offset
+	uint32 fieldIndicesSize = 0;
+	for (std::vector<Struct>::const_iterator s = _structs.begin(); s != _structs.end(); ++s)
+		if (s->fieldCount > 1)
+			fieldIndicesSize += s->fieldCount * 4;
+
+	// List fields reference their lists by byte offset, too
+	std::vector<uint32> listOffsets(_lists.size());
+
+	uint32 listIndicesSize = 0;
+	for (uint32 i = 0; i < _lists.size(); i++) {
+		listOffsets[i] = listIndicesSize;
+
+		listIndicesSize += (1 + _lists[i].structCount) * 4;
+	}
+
+	// The arrays follow each other directly, right after the header
+	const uint32 structOffset       = 56;
+	const uint32 fieldOffset        = structOffset + _structs.size() * 12;
+	const uint32 labelOffset        = fieldOffset  + _fields.size()  * 12;
+	const uint32 fieldDataOffset    = labelOffset  + _labels.size()  * 16;
+	const uint32 fieldIndicesOffset = fieldDataOffset + _fieldData.size();
+	const uint32 listIndicesOffset  = fieldIndicesOffset + fieldIndicesSize;
+
+	std::vector<byte> table(56);
+
+	WRITE_BE_UINT32(&table[ 0], _id);
+	WRITE_BE_UINT32(&table[ 4], kVersion32);
+	WRITE_LE_UINT32(&table[ 8], structOffset);
+	WRITE_LE_UINT32(&table[12], _structs.size());
+	WRITE_LE_UINT32(&table[16], fieldOffset);
+	WRITE_LE_UINT32(&table[20], _fields.size());
+	WRITE_LE_UINT32(&table[24], labelOffset);
+	WRITE_LE_UINT32(&table[28], _labels.size());
+	WRITE_LE_UINT32(&table[32], fieldDataOffset);
+	WRITE_LE_UINT32(&table[36], _fieldData.size());
+	WRITE_LE_UINT32(&table[40], fieldIndicesOffset);
+	WRITE_LE_UINT32(&table[44], fieldIndicesSize);
+	WRITE_LE_UINT32(&table[48], listIndicesOffset);
+	WRITE_LE_UINT32(&table[52], listIndicesSize);
+
+	writeTable(stream, table);
+
+	// Structs
+	table.resize(_structs.size() * 12);
+
+	uint32 fieldIndex = 0;
+	for (uint32 i = 0; i < _structs.size(); i++) {
+		const Struct &s = _structs[i];
+
+		uint32 data = kNone;
+		if        (s.fieldCount == 1) {
+			data = s.firstField;
+		} else if (s.fieldCount > 1) {
+			data = fieldIndex;
+
+			fieldIndex += s.fieldCount * 4;
+		}
+
+		WRITE_LE_UINT32(&table[i * 12 + 0], s.id);
+		WRITE_LE_UINT32(&table[i * 12 + 4], data);
+		WRITE_LE_UINT32(&table[i * 12 + 8], s.fieldCount);
+	}
+
+	writeTable(stream, table);
+
+	// Fields
+	table.resize(_fields.size() * 12);
+
+	for (uint32 i = 0; i < _fields.size(); i++) {
+		const Field &f = _fields[i];
+
+		const uint32 data = (f.type == GFFStruct::kFieldTypeList) ? listOffsets[f.data] : f.data;
+
+		WRITE_LE_UINT32(&table[i * 12 + 0], f.type);
+		WRITE_LE_UINT32(&table[i * 12 + 4], f.label);
+		WRITE_LE_UINT32(&table[i * 12 + 8], data);
+	}
+
+	writeTable(stream, table);
+
+	// Labels
+	table.clear();
+	table.resize(_labels.size() * 16, 0);
+
+	for (uint32 i = 0; i < _labels.size(); i++)
+		std::memcpy(&table[i * 16], _labels[i].c_str(), std::strlen(_labels[i].c_str()));
+
+	writeTable(stream, table);
+
+	// Field data
+	writeTable(stream, _fieldData);
+
+	// Field indices
+	table.resize(fieldIndicesSize);
+
+	byte *entry = table.empty() ? 0 : &table[0];
+	for (std::vector<Struct>::const_iterator s = _structs.begin(); s != _structs.end(); ++s) {
+		if (s->fieldCount <= 1)
+			continue;
+
+		for (uint32 f = s->firstField; f != kNone; f = _fields[f].next, entry += 4)
+			WRITE_LE_UINT32(entry, f);
+	}
+
+	writeTable(stream, table);
+
+	// List indices
+	table.resize(listIndicesSize);
+
+	entry = table.empty() ? 0 : &table[0];
+	for (std::vector<List>::const_iterator l = _lists.begin(); l != _lists.end(); ++l) {
+		WRITE_LE_UINT32(entry, l->structCount);
+		entry += 4;
+
+		for (uint32 s = l->firstStruct; s != kNone; s = _structs[s].next, entry += 4)
+			WRITE_LE_UINT32(entry, s);
+	}
+
+	writeTable(stream, table);
+
+	if (!stream.flush())
+		throw Common::Exception(Common::kWriteError);
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,166 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/gffwriter.h
+ *  Writing BioWare's GFFs (generic file format).
+ */
+
+#ifndef AURORA_GFFWRITER_H
+#define AURORA_GFFWRITER_H
+
+#include <vector>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Aurora {
+
+class LocString;
+
+/** Assembles a GFF and writes it out.
+ *
+ *  Structs and lists are referenced by their indices, the top-level struct
+ *  being struct 0. All structs, fields and lists are kept in flat arrays
+ *  and all extended field data in a single growing buffer, so building a
+ *  GFF needs very few allocations. Each label and each distinct piece of
+ *  extended field data is only stored once.
+ *
+ *  Each label may only be added once to each struct. Adding it again
+ *  throws an exception.
+ */
+class GFFWriter {
+public:
+	GFFWriter(uint32 id);
+	~GFFWriter();
+
+	/** Return the index of the top-level struct. */
+	uint32 getTopLevel() const;
+
+	/** Add a struct field to a struct, returning the index of the new struct. */
+	uint32 addStruct(uint32 strct, const Common::UString &label, uint32 id);
+
+	/** Add a list field to a struct, returning the index of the new list. */
+	uint32 addList(uint32 strct, const Common::UString &label);
+	/** Append a new struct to a list, returning the index of the new struct. */
+	uint32 addListStruct(uint32 list, uint32 id);
+
+	void addByte  (uint32 strct, const Common::UString &label, uint8  value);
+	void addChar  (uint32 strct, const Common::UString &label, char   value);
+	void addUint16(uint32 strct, const Common::UString &label, uint16 value);
+	void addSint16(uint32 strct, const Common::UString &label, int16  value);
+	void addUint32(uint32 strct, const Common::UString &label, uint32 value);
+	void addSint32(uint32 strct, const Common::UString &label, int32  value);
+	void addUint64(uint32 strct, const Common::UString &label, uint64 value);
+	void addSint64(uint32 strct, const Common::UString &label, int64  value);
+
+	void addFloat (uint32 strct, const Common::UString &label, float  value);
+	void addDouble(uint32 strct, const Common::UString &label, double value);
+
+	void addExoString(uint32 strct, const Common::UString &label, const Common::UString &value);
+	void addResRef   (uint32 strct, const Common::UString &label, const Common::UString &value);
+	void addLocString(uint32 strct, const Common::UString &label, const LocString &value);
+
+	void addVoid(uint32 strct, const Common::UString &label, const byte *data, uint32 size);
+
+	void addVector     (uint32 strct, const Common::UString &label,
+			float x, float y, float z);
+	void addOrientation(uint32 strct, const Common::UString &label,
+			float a, float b, float c, float d);
+
+	/** Write the whole GFF out into a stream. */
+	void write(Common::WriteStream &stream) const;
+
+private:
+	/** A struct to be written. */
+	struct Struct {
+		uint32 id;         ///< The struct's ID.
+		uint32 fieldCount; ///< Number of fields in the struct.
+		uint32 firstField; ///< Index of the struct's first field.
+		uint32 lastField;  ///< Index of the struct's last field.
+		uint32 next;       ///< Index of the next struct in the same list.
+
+		Struct(uint32 i);
+	};
+
+	/** A field to be written. */
+	struct Field {
+		uint32 type;  ///< Type of the field.
+		uint32 label; ///< Index of the field's label.
+		uint32 data;  ///< Data of the field.
+		uint32 next;  ///< Index of the next field in the same struct.
+
+		Field(uint32 t, uint32 l, uint32 d);
+	};
+
+	/** A list to be written. */
+	struct List {
+		uint32 structCount; ///< Number of structs in the list.
+		uint32 firstStruct; ///< Index of the list's first struct.
+		uint32 lastStruct;  ///< Index of the list's last struct.
+
+		List();
+	};
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelMap;
+
+	/** Offset and size of a piece of extended field data. */
+	typedef std::pair<uint32, uint32> DataRange;
+	/** All pieces of extended field data, by the hash of their contents. */
+	typedef boost::unordered_multimap<std::size_t, DataRange> DataMap;
+
+
+	uint32 _id; ///< The GFF's ID.
+
+	std::vector<Struct> _structs;
+	std::vector<Field>  _fields;
+	std::vector<List>   _lists;
+
+	std::vector<Common::UString> _labels;       ///< All labels.
+	LabelMap                     _labelIndices; ///< The indices of all labels.
+
+	std::vector<byte> _fieldData; ///< The extended field data of all fields.
+	DataMap           _dataMap;   ///< Where to find which extended field data.
+
+
+	/** Return the index of a label, adding it if necessary. */
+	uint32 getLabel(const Common::UString &label);
+
+	/** Store extended field data, returning its offset. */
+	uint32 addData(const byte *data, uint32 size);
+
+	void addField(uint32 strct, const Common::UString &label, uint32 type, uint32 data);
+	void addExtendedField(uint32 strct, const Common::UString &label, uint32 type,
+	                      const byte *data, uint32 size);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_GFFWRITER_H
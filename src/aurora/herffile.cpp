@@ -38,7 +38,22 @@
 
 namespace Aurora {
 
-HERFFile::HERFFile(const Common::UString &fileName) : _fileName(fileName) {
+/** A view of a resource within a HERF file, keeping the HERF file alive. */
+class HERFResourceStream : public Common::MemoryReadStream {
+public:
+	HERFResourceStream(const boost::shared_ptr<Common::MemoryReadStream> &herf, uint32 offset, uint32 size) :
+		Common::MemoryReadStream(herf->getData() + offset, size), _herf(herf) {
+	}
+
+	~HERFResourceStream() {
+	}
+
+private:
+	boost::shared_ptr<Common::MemoryReadStream> _herf;
+};
+
+
+HERFFile::HERFFile(const Common::UString &fileName) : Archive(fileName), _fileName(fileName) {
 	load();
 }
 
@@ -54,26 +69,44 @@ void HERFFile::load() {
 	if (!herf)
 		throw Common::Exception(Common::kOpenError);
 
+	// Keep the whole HERF around, in memory, to hand out views into it
+	Common::MemoryReadStream *herfMemory = dynamic_cast<Common::MemoryReadStream *>(herf);
+	if (!herfMemory) {
+		try {
+			herfMemory = herf->readStream(herf->size());
+		} catch (...) {
+			delete herf;
+			throw;
+		}
+
+		delete herf;
+	}
+
+	_herf.reset(herfMemory);
+
 	// Read in the resource table
-	herf->skip(4);
-	uint32 resCount = herf->readUint32LE();
+	_herf->skip(4);
+	uint32 resCount = _herf->readUint32LE();
+
+	_iResources.rehash(resCount);
 
 	for (uint32 i = 0; i < resCount; i++) {
-		uint32 nameHash = herf->readUint32LE();
+		uint32 nameHash = _herf->readUint32LE();
 
 		IResource &iResource = _iResources[nameHash];
 
-		iResource.size = herf->readUint32LE();
-		iResource.offset = herf->readUint32LE();
+		iResource.size = _herf->readUint32LE();
+		iResource.offset = _herf->readUint32LE();
 
-		if (iResource.offset >= (uint32)herf->size())
+		if ((iResource.offset >= (uint32)_herf->size()) ||
+		    (iResource.size > ((uint32)_herf->size() - iResource.offset)))
 			throw Common::Exception("HERFFile::load(): Resource goes beyond end of file");
 	}
 
-	readNames();
-
-	if (herf->err())
+	if (_herf->err())
 		throw Common::Exception(Common::kReadError);
+
+	readNames();
 }
 
 void HERFFile::readNames() {
@@ -113,10 +146,11 @@ const Archive::ResourceList &HERFFile::getResources() const {
 }
 
 const HERFFile::IResource &HERFFile::getIResource(uint32 index) const {
-	if (_iResources.count(index) == 0)
+	IResourceMap::const_iterator res = _iResources.find(index);
+	if (res == _iResources.end())
 		throw Common::Exception("Resource hash not found 0x%08x", index);
 
-	return _iResources.find(index)->second;
+	return res->second;
 }
 
 uint32 HERFFile::getResourceSize(uint32 index) const {
@@ -128,21 +162,11 @@ Common::SeekableReadStream *HERFFile::getResource(uint32 index) const {
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::SeekableReadStream *herf = ResMan.getResource(setFileType(_fileName, kFileTypeNone), kFileTypeHERF);
-	if (!herf)
-		throw Common::Exception(Common::kOpenError);
-
-	if (!herf->seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
-
-	Common::SeekableReadStream *resStream = herf->readStream(res.size);
-
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
-		throw Common::Exception(Common::kReadError);
-	}
+	return new HERFResourceStream(_herf, res.offset, res.size);
+}
 
-	return resStream;
+bool HERFFile::isThreadSafe() const {
+	return true;
 }
 
 // djb2 hash function by Daniel J. Bernstein
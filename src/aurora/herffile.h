@@ -30,7 +30,8 @@
 #ifndef AURORA_HERFFILE_H
 #define AURORA_HERFFILE_H
 
-#include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "common/types.h"
 #include "common/ustring.h"
@@ -40,6 +41,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class MemoryReadStream;
 	class File;
 }
 
@@ -60,9 +62,16 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
-	/** Return a stream of the resource's contents. */
+	/** Return a stream of the resource's contents.
+	 *
+	 *  The data is not copied. Instead, the stream is a view into the HERF,
+	 *  sharing ownership of it.
+	 */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
 private:
 	/** Internal resource information. */
 	struct IResource {
@@ -70,18 +79,19 @@ private:
 		uint32 size;     ///< The resource's size.
 	};
 
-	typedef std::map<uint32, IResource> IResourceMap;
+	typedef boost::unordered_map<uint32, IResource> IResourceMap;
 
 	/** External list of resource names and types. */
 	ResourceList _resources;
 
-	/** Internal list of resource offsets and sizes. */
+	/** Internal list of resource offsets and sizes, by name hash. */
 	IResourceMap _iResources;
 
 	/** The name of the HERF file. */
 	Common::UString _fileName;
 
-	void open(Common::File &file) const;
+	/** The whole HERF file. */
+	boost::shared_ptr<Common::MemoryReadStream> _herf;
 
 	void load();
 	void readNames();
@@ -27,6 +27,8 @@
  *  Handling BioWare's KEYs (resource index files).
  */
 
+#include <cstring>
+
 #include "common/util.h"
 #include "common/error.h"
 #include "common/stream.h"
@@ -34,6 +36,7 @@
 
 #include "aurora/keyfile.h"
 #include "aurora/error.h"
+#include "aurora/util.h"
 
 static const uint32 kKEYID     = MKID_BE('KEY ');
 static const uint32 kVersion1  = MKID_BE('V1  ');
@@ -96,45 +99,72 @@ void KEYFile::load(Common::SeekableReadStream &key) {
 }
 
 void KEYFile::readBIFList(Common::SeekableReadStream &key, uint32 offset) {
-	if (!key.seek(offset))
-		throw Common::Exception(Common::kSeekError);
+	// Each file entry takes up 12 bytes
+	std::vector<byte> table;
+	readTable(key, offset, _bifs.size(), 12, table);
+
+	std::vector<uint32> nameOffsets(_bifs.size());
+	std::vector<uint32> nameSizes(_bifs.size());
+
+	// The names usually follow each other, so read them in one go as well
+	uint32 namesStart = 0xFFFFFFFF;
+	uint32 namesEnd   = 0;
+
+	for (uint32 i = 0; i < _bifs.size(); i++) {
+		const byte *entry = &table[i * 12];
 
-	for (BIFList::iterator bif = _bifs.begin(); bif != _bifs.end(); ++bif) {
-		key.skip(4); // File size of the bif
+		// entry + 0: File size of the bif
 
-		uint32 nameOffset = key.readUint32LE();
-		uint32 nameSize   = 0;
+		nameOffsets[i] = READ_LE_UINT32(entry + 4);
 
 		// nameSize is expanded to 4 bytes in 1.1 and the location is dropped
-		if (_version == kVersion11) {
-			nameSize = key.readUint32LE();
-		} else {
-			nameSize = key.readUint16LE();
-			key.skip(2); // Location of the bif (HD, CD, ...)
-		}
+		if (_version == kVersion11)
+			nameSizes[i] = READ_LE_UINT32(entry + 8);
+		else
+			nameSizes[i] = READ_LE_UINT16(entry + 8);
 
-		uint32 curPos = key.seekTo(nameOffset);
-		bif->readFixedASCII(key, nameSize);
-		key.seekTo(curPos);
+		if ((nameOffsets[i] > (uint32) key.size()) || (nameSizes[i] > ((uint32) key.size() - nameOffsets[i])))
+			throw Common::Exception("BIF name goes beyond end of file");
 
-		AuroraFile::cleanupPath(*bif);
+		namesStart = MIN(namesStart, nameOffsets[i]);
+		namesEnd   = MAX(namesEnd  , nameOffsets[i] + nameSizes[i]);
+	}
+
+	std::vector<byte> names;
+	if (namesStart < namesEnd)
+		readTable(key, namesStart, namesEnd - namesStart, 1, names);
+
+	for (uint32 i = 0; i < _bifs.size(); i++) {
+		if (nameSizes[i] == 0)
+			continue;
+
+		const char *name = (const char *) &names[0] + (nameOffsets[i] - namesStart);
+
+		_bifs[i] = Common::UString(name, getPaddedLength(name, nameSizes[i]));
+
+		AuroraFile::cleanupPath(_bifs[i]);
 	}
 }
 
 void KEYFile::readResList(Common::SeekableReadStream &key, uint32 offset) {
-	if (!key.seek(offset))
-		throw Common::Exception(Common::kSeekError);
+	// Version 1.1 has an additional flags field
+	const uint32 entrySize = (_version == kVersion11) ? 26 : 22;
+
+	std::vector<byte> table;
+	readTable(key, offset, _resources.size(), entrySize, table);
 
-	for (ResourceList::iterator res = _resources.begin(); res != _resources.end(); ++res) {
-		res->name.readFixedASCII(key, 16);
-		res->type = (FileType) key.readUint16LE();
+	const byte *entry = table.empty() ? 0 : &table[0];
+	for (ResourceList::iterator res = _resources.begin(); res != _resources.end(); ++res, entry += entrySize) {
+		std::memcpy(res->name, entry, 16);
 
-		uint32 id = key.readUint32LE();
+		res->type = (FileType) READ_LE_UINT16(entry + 16);
+
+		uint32 id = READ_LE_UINT32(entry + 18);
 
 		// The new flags field holds the bifIndex now. The rest contains fixed
 		// resource info.
 		if (_version == kVersion11) {
-			uint32 flags = key.readUint32LE();
+			uint32 flags = READ_LE_UINT32(entry + 22);
 			res->bifIndex = (flags & 0xFFF00000) >> 20;
 		} else
 			res->bifIndex = id >> 20;
@@ -144,6 +174,10 @@ void KEYFile::readResList(Common::SeekableReadStream &key, uint32 offset) {
 	}
 }
 
+Common::UString KEYFile::Resource::getName() const {
+	return Common::UString(name, getPaddedLength(name, sizeof(name)));
+}
+
 const KEYFile::BIFList &KEYFile::getBIFs() const {
 	return _bifs;
 }
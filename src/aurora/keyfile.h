@@ -50,11 +50,14 @@ class KEYFile : public AuroraBase {
 public:
 	/** A key resource index. */
 	struct Resource {
-		Common::UString name; ///< The resource's name.
-		FileType        type; ///< The resource's type.
+		char     name[16]; ///< The resource's name, 0-padded. Not necessarily 0-terminated.
+		FileType type;     ///< The resource's type.
 
 		uint32 bifIndex; ///< Index into the bif list.
 		uint32 resIndex; ///< Index into the bif's resource table.
+
+		/** Return the resource's name as a string. */
+		Common::UString getName() const;
 	};
 
 	typedef std::vector<Resource> ResourceList;
@@ -101,6 +101,12 @@ static inline int mapLanguageToStorage(Aurora::Language language) {
 	return n;
 }
 
+/** Map storage space back to the language ID written into game data. */
+static const uint32 storageToLanguage[] = {
+	  0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,
+	256, 257, 258, 259, 260, 261, 262, 263,  20,  21,  22
+};
+
 namespace Aurora {
 
 LocString::LocString() : _id(kStrRefInvalid) {
@@ -128,6 +134,12 @@ bool LocString::hasString(Language language) const {
 	return !_strings[mapLanguageToStorage(language)].empty();
 }
 
+void LocString::getLanguages(std::vector<Language> &languages) const {
+	for (int i = 0; i < kStringCount; i++)
+		if (!_strings[i].empty())
+			languages.push_back((Language) storageToLanguage[i]);
+}
+
 const Common::UString &LocString::getString(Language language) const {
 	return _strings[mapLanguageToStorage(language)];
 }
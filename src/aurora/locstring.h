@@ -30,6 +30,8 @@
 #ifndef AURORA_LOCSTRING_H
 #define AURORA_LOCSTRING_H
 
+#include <vector>
+
 #include "common/types.h"
 #include "common/ustring.h"
 
@@ -59,6 +61,9 @@ public:
 	/** Does the LocString have a string of this language? */
 	bool hasString(Language language) const;
 
+	/** Add all languages the LocString has a string of to the list. */
+	void getLanguages(std::vector<Language> &languages) const;
+
 	/** Get the string of that language. */
 	const Common::UString &getString(Language language) const;
 	/** Set the string of that language. */
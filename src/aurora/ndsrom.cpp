@@ -38,10 +38,11 @@
 #include "aurora/ndsrom.h"
 #include "aurora/error.h"
 #include "aurora/util.h"
+#include "aurora/resman.h"
 
 namespace Aurora {
 
-NDSFile::NDSFile(const Common::UString &fileName) : _fileName(fileName) {
+NDSFile::NDSFile(const Common::UString &fileName) : Archive(fileName), _fileName(fileName) {
 	load();
 }
 
@@ -145,25 +146,29 @@ uint32 NDSFile::getResourceSize(uint32 index) const {
 	return getIResource(index).size;
 }
 
+uint32 NDSFile::getResourceOffset(uint32 index) const {
+	return getIResource(index).offset;
+}
+
 Common::SeekableReadStream *NDSFile::getResource(uint32 index) const {
 	const IResource &res = getIResource(index);
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File nds;
-	open(nds);
-
-	if (!nds.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
-
-	Common::SeekableReadStream *resStream = nds.readStream(res.size);
+	// Borrow an open NDS file handle from the resource manager
+	boost::shared_ptr<Common::File> nds = ResMan.getArchiveFile(_fileName);
 
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
+	byte *data = new byte[res.size];
+	if (nds->readAt(res.offset, data, res.size) != res.size) {
+		delete[] data;
 		throw Common::Exception(Common::kReadError);
 	}
 
-	return resStream;
+	return new Common::MemoryReadStream(data, res.size, true);
+}
+
+bool NDSFile::isThreadSafe() const {
+	return true;
 }
 
 void NDSFile::open(Common::File &file) const {
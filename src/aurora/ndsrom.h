@@ -60,9 +60,15 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
+	/** Return the offset of a resource within the archive file. */
+	uint32 getResourceOffset(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
 	/** Check if a stream is a valid Nintendo DS ROM. */
 	static bool isNDS(Common::SeekableReadStream &stream);
 
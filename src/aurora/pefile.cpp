@@ -39,7 +39,7 @@
 namespace Aurora {
 
 PEFile::PEFile(const Common::UString &fileName, const std::vector<Common::UString> &remap) :
-	_peFile(0) {
+	Archive(fileName), _peFile(0) {
 
 	Common::File *file = new Common::File();
 	if (!file->open(fileName)) {
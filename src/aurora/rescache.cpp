@@ -0,0 +1,232 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/rescache.cpp
+ *  A memory budgeted cache of resource payloads.
+ */
+
+#include "common/error.h"
+#include "common/stream.h"
+#include "common/mappedfile.h"
+
+#include "aurora/rescache.h"
+
+/** Payloads bigger than this share of the budget are not cached. */
+static const uint32 kMaxPayloadShare = 8;
+
+namespace Aurora {
+
+/** A read-only stream over a cached payload, sharing ownership of it. */
+class PayloadReadStream : public Common::MemoryReadStream {
+public:
+	PayloadReadStream(const boost::shared_array<byte> &data, uint32 size) :
+		Common::MemoryReadStream(data.get(), size), _data(data) {
+	}
+
+	~PayloadReadStream() {
+	}
+
+private:
+	boost::shared_array<byte> _data;
+};
+
+
+ResourceCache::Key::Key(const Archive *a, uint32 i, const Common::UString &p) :
+	archive(a), index(i), path(p) {
+}
+
+bool ResourceCache::Key::operator<(const Key &right) const {
+	if (archive != right.archive)
+		return archive < right.archive;
+	if (index != right.index)
+		return index < right.index;
+
+	return path < right.path;
+}
+
+
+ResourceCache::ResourceCache(uint32 budget) : _budget(budget), _size(0),
+	_hits(0), _misses(0), _evictions(0) {
+
+}
+
+ResourceCache::~ResourceCache() {
+	clear();
+}
+
+uint32 ResourceCache::getBudget() const {
+	Common::StackLock lock(_mutex);
+
+	return _budget;
+}
+
+void ResourceCache::setBudget(uint32 budget) {
+	Common::StackLock lock(_mutex);
+
+	_budget = budget;
+
+	shrink(_budget);
+}
+
+bool ResourceCache::isEnabled() const {
+	Common::StackLock lock(_mutex);
+
+	return _budget != 0;
+}
+
+void ResourceCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	_entries.clear();
+	_usage.clear();
+
+	_size = 0;
+}
+
+void ResourceCache::removeArchive(const Archive *archive) {
+	Common::StackLock lock(_mutex);
+
+	// All resources of an archive are sorted together, at the front for plain files
+	EntryMap::iterator entry = _entries.lower_bound(Key(archive, 0, ""));
+	while ((entry != _entries.end()) && (entry->first.archive == archive))
+		remove(entry++);
+}
+
+Common::SeekableReadStream *ResourceCache::get(const Archive *archive, uint32 index,
+		const Common::UString &path) {
+
+	Common::StackLock lock(_mutex);
+
+	if (_budget == 0)
+		return 0;
+
+	EntryMap::iterator entry = _entries.find(Key(archive, index, path));
+	if (entry == _entries.end())
+		return 0;
+
+	_hits++;
+
+	// Mark the payload as the most recently used
+	_usage.splice(_usage.end(), _usage, entry->second.usage);
+
+	return new PayloadReadStream(entry->second.data, entry->second.size);
+}
+
+Common::SeekableReadStream *ResourceCache::add(const Archive *archive, uint32 index,
+		const Common::UString &path, Common::SeekableReadStream *stream) {
+
+	if (!stream)
+		return 0;
+
+	// Memory mapped resources can already be read again at no cost
+	if (dynamic_cast<Common::MappedReadStream *>(stream))
+		return stream;
+
+	uint32 size = stream->size();
+
+	{
+		Common::StackLock lock(_mutex);
+
+		_misses++;
+
+		if ((_budget == 0) || (size > (_budget / kMaxPayloadShare)))
+			return stream;
+	}
+
+	boost::shared_array<byte> data(new byte[size]);
+
+	try {
+		if (!stream->seek(0) || (stream->read(data.get(), size) != size))
+			throw Common::Exception(Common::kReadError);
+	} catch (...) {
+		delete stream;
+		throw;
+	}
+
+	delete stream;
+
+	Common::StackLock lock(_mutex);
+
+	// The budget might have been lowered in the meantime
+	if ((_budget == 0) || (size > (_budget / kMaxPayloadShare)))
+		return new PayloadReadStream(data, size);
+
+	std::pair<EntryMap::iterator, bool> entry =
+		_entries.insert(std::make_pair(Key(archive, index, path), Entry()));
+
+	if (!entry.second) {
+		// Someone else added it in the meantime, use theirs
+		_usage.splice(_usage.end(), _usage, entry.first->second.usage);
+
+		return new PayloadReadStream(entry.first->second.data, entry.first->second.size);
+	}
+
+	shrink((_budget >= size) ? (_budget - size) : 0);
+
+	entry.first->second.data  = data;
+	entry.first->second.size  = size;
+	entry.first->second.usage = _usage.insert(_usage.end(), entry.first);
+
+	_size += size;
+
+	return new PayloadReadStream(data, size);
+}
+
+void ResourceCache::getStats(Stats &stats) const {
+	Common::StackLock lock(_mutex);
+
+	stats.hits      = _hits;
+	stats.misses    = _misses;
+	stats.evictions = _evictions;
+
+	stats.count  = _entries.size();
+	stats.size   = _size;
+	stats.budget = _budget;
+}
+
+void ResourceCache::resetStats() {
+	Common::StackLock lock(_mutex);
+
+	_hits      = 0;
+	_misses    = 0;
+	_evictions = 0;
+}
+
+void ResourceCache::remove(EntryMap::iterator entry) {
+	_size -= entry->second.size;
+
+	_usage.erase(entry->second.usage);
+	_entries.erase(entry);
+}
+
+void ResourceCache::shrink(uint32 budget) {
+	while ((_size > budget) && !_usage.empty()) {
+		remove(_usage.front());
+
+		_evictions++;
+	}
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,152 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/rescache.h
+ *  A memory budgeted cache of resource payloads.
+ */
+
+#ifndef AURORA_RESCACHE_H
+#define AURORA_RESCACHE_H
+
+#include <list>
+#include <map>
+
+#include <boost/shared_array.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/noncopyable.h"
+#include "common/mutex.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+class Archive;
+
+/** A cache of resource payloads, bounded by a memory budget.
+ *
+ *  The payloads are shared between the cache and all streams handed out for
+ *  them, so a payload evicted from the cache stays valid for as long as a
+ *  stream still reads it. When the cache is over budget, the least recently
+ *  used payloads are evicted first.
+ *
+ *  Resources are identified by their archive and index within the archive,
+ *  or by their path for resources in plain files.
+ */
+class ResourceCache : public Common::NonCopyable {
+public:
+	/** Statistics about the cache's performance. */
+	struct Stats {
+		uint64 hits;      ///< Number of requests served from the cache.
+		uint64 misses;    ///< Number of cacheable resources that had to be read.
+		uint64 evictions; ///< Number of payloads evicted to stay within budget.
+
+		uint32 count;  ///< Number of payloads currently cached.
+		uint32 size;   ///< Bytes currently cached.
+		uint32 budget; ///< Maximum number of bytes cached.
+	};
+
+	/** Create a cache. A budget of 0 disables it. */
+	ResourceCache(uint32 budget = 0);
+	~ResourceCache();
+
+	/** Return the maximum number of bytes cached. */
+	uint32 getBudget() const;
+	/** Set the maximum number of bytes cached. 0 disables the cache. */
+	void setBudget(uint32 budget);
+
+	/** Is the cache enabled? */
+	bool isEnabled() const;
+
+	/** Drop all cached payloads. */
+	void clear();
+
+	/** Drop all cached payloads of resources within that archive. */
+	void removeArchive(const Archive *archive);
+
+	/** Return a stream of a cached resource, or 0 if it's not cached. */
+	Common::SeekableReadStream *get(const Archive *archive, uint32 index, const Common::UString &path);
+
+	/** Add a resource to the cache.
+	 *
+	 *  Takes over the stream, and returns a stream of the same data.
+	 *  Resources bigger than an eighth of the budget, or that are already
+	 *  memory mapped, are not cached and returned as is.
+	 */
+	Common::SeekableReadStream *add(const Archive *archive, uint32 index, const Common::UString &path,
+	                                Common::SeekableReadStream *stream);
+
+	/** Return statistics about the cache's performance. */
+	void getStats(Stats &stats) const;
+	/** Reset the hits, misses and evictions counters. */
+	void resetStats();
+
+private:
+	/** What identifies a cached resource. */
+	struct Key {
+		const Archive  *archive;
+		uint32          index;
+		Common::UString path;
+
+		Key(const Archive *a, uint32 i, const Common::UString &p);
+
+		bool operator<(const Key &right) const;
+	};
+
+	struct Entry;
+
+	typedef std::map<Key, Entry> EntryMap;
+	typedef std::list<EntryMap::iterator> UsageList;
+
+	/** A cached payload. */
+	struct Entry {
+		boost::shared_array<byte> data;
+		uint32 size;
+
+		UsageList::iterator usage; ///< Position in the usage list.
+	};
+
+	uint32 _budget; ///< Maximum number of bytes cached.
+	uint32 _size;   ///< Bytes currently cached.
+
+	EntryMap  _entries;
+	UsageList _usage;   ///< The cached payloads, least recently used first.
+
+	uint64 _hits;
+	uint64 _misses;
+	uint64 _evictions;
+
+	mutable Common::Mutex _mutex;
+
+	void remove(EntryMap::iterator entry);
+	void shrink(uint32 budget);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESCACHE_H
@@ -27,12 +27,18 @@
  *  The global resource manager for Aurora resources.
  */
 
+#include <algorithm>
+#include <functional>
+
 #include <boost/algorithm/string.hpp>
 
 #include "common/util.h"
 #include "common/stream.h"
 #include "common/filepath.h"
 #include "common/file.h"
+#include "common/mappedfile.h"
+#include "common/workerpool.h"
+#include "common/mutex.h"
 
 #include "aurora/resman.h"
 #include "aurora/util.h"
@@ -56,9 +62,67 @@ static const char *kArchiveGlob[Aurora::kArchiveMAX] = {
 	".*\\.key", ".*\\.bif", ".*\\.(erf|mod|hak|nwm)", ".*\\.rim", ".*\\.zip", ".*\\.exe"
 };
 
+/** The number of archive files kept open at the same time. */
+static const uint32 kArchiveFilePoolSize = 32;
+
+/** Marks an empty bucket in the resource hash table. */
+static const uint32 kNoEntry = 0xFFFFFFFF;
+
+/** The initial number of buckets in the resource hash table. Must be a power of 2. */
+static const uint32 kInitialBucketCount = 1024;
+
+/** The number of extra threads loading archives in ResourceManager::addArchives(). */
+static const uint32 kArchiveLoaderThreadCount = 3;
+
+static const uint32 kIndexCacheID      = MKID_BE('XIDX');
+static const uint32 kIndexCacheVersion = 1;
+
+static const uint32 kTraceID      = MKID_BE('XTRC');
+static const uint32 kTraceVersion = 1;
+
+static inline byte asciiToLower(byte c) {
+	return ((c >= 'A') && (c <= 'Z')) ? (c + ('a' - 'A')) : c;
+}
+
+/** Hash a resource name, ignoring case.
+ *
+ *  This is a FNV-1a hash over the UTF-8 bytes of the name. Only ASCII
+ *  characters are folded to lowercase, matching Common::UString::tolower().
+ */
+static uint32 hashName(const Common::UString &name) {
+	uint32 hash = 2166136261U;
+
+	for (const byte *c = (const byte *) name.c_str(); *c; c++)
+		hash = (hash ^ asciiToLower(*c)) * 16777619U;
+
+	return hash;
+}
+
+/** Combine the hash of a resource name with the resource type. */
+static inline uint32 hashResource(uint32 nameHash, Aurora::FileType type) {
+	uint32 hash = nameHash ^ (((uint32) type) * 2654435761U);
+
+	// Mix the bits, so that the lower ones are usable as a bucket index
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+
+	return hash;
+}
+
+/** Compare a lowercase resource name with another name, ignoring case. */
+static bool equalsName(const Common::UString &lowerName, const Common::UString &name) {
+	const byte *c1 = (const byte *) lowerName.c_str();
+	const byte *c2 = (const byte *) name.c_str();
+
+	for (; *c1 && (*c1 == asciiToLower(*c2)); c1++, c2++);
+
+	return *c1 == asciiToLower(*c2);
+}
+
 namespace Aurora {
 
-ResourceManager::Resource::Resource() : type(kFileTypeNone), priority(0),
+ResourceManager::Resource::Resource() : type(kFileTypeNone), priority(0), changeSet(0),
 		source(kSourceNone), archive(0), archiveIndex(0xFFFFFFFF) {
 }
 
@@ -82,7 +146,246 @@ ResourceManager::ChangeID::ChangeID(ChangeSetList::iterator c) : _empty(false),
 }
 
 
-ResourceManager::ResourceManager() : _rimsAreERFs(false) {
+ResourceManager::AccessStats::AccessStats() : lookups(0), misses(0), reads(0), bytes(0), time(0) {
+	for (uint32 i = 0; i < kLatencyBucketCount; i++)
+		latency[i] = 0;
+}
+
+void ResourceManager::AccessStats::addRead(uint64 size, uint64 readTime) {
+	reads++;
+	bytes += size;
+	time  += readTime;
+
+	uint32 bucket = 0;
+	while ((bucket < (kLatencyBucketCount - 1)) && (readTime >= (((uint64) 16) << bucket)))
+		bucket++;
+
+	latency[bucket]++;
+}
+
+
+ResourceManager::ArchiveBatchEntry::ArchiveBatchEntry(ArchiveType a, const Common::UString &f, uint32 p) :
+	archive(a), file(f), priority(p) {
+}
+
+
+/** Loading one archive of a ResourceManager::addArchives() batch. */
+class ResourceManager::ArchiveLoader : public Common::Job {
+public:
+	ArchiveType     archive;
+	Common::UString file;
+
+	bool deferred; ///< Has to be loaded after the previous archives are indexed.
+
+	std::vector<Archive *> archives; ///< The loaded archives.
+
+	ArchiveLoader(ResourceManager &resMan, ArchiveType a, const Common::UString &f) :
+		archive(a), file(f), deferred(a == kArchiveHERF), _resMan(&resMan) {
+	}
+
+	~ArchiveLoader() {
+	}
+
+private:
+	ResourceManager *_resMan;
+
+	void run() {
+		if (!deferred)
+			_resMan->loadArchive(archive, file, archives);
+	}
+};
+
+
+/** A resource read in the background. */
+struct ResourceManager::PrefetchRequest {
+	Common::UString name; ///< The name of the resource.
+	FileType        type; ///< The type of the resource.
+
+	bool queued; ///< Is the resource read by the I/O thread?
+	bool done;   ///< Has the I/O thread finished reading the resource?
+	bool taken;  ///< Has the resource stream been taken?
+
+	bool           readAhead; ///< Is the resource only read to have it cached?
+	ResourceCache *cache;     ///< The cache to put the read resource into.
+
+	Resource resource; ///< The resource to read.
+
+	Common::SeekableReadStream *stream; ///< The resource stream that was read.
+
+	bool              failed; ///< Did reading the resource fail?
+	Common::Exception error;  ///< Why did reading the resource fail?
+
+	Common::Mutex     mutex;
+	Common::Condition ready; ///< Signalled when the resource was read.
+
+	PrefetchRequest(const Common::UString &n, FileType t) : name(n), type(t),
+		queued(false), done(false), taken(false), readAhead(false), cache(0),
+		stream(0), failed(false), ready(mutex) {
+	}
+
+	~PrefetchRequest() {
+		delete stream;
+	}
+};
+
+
+/** Reading a prefetched resource on the background I/O thread. */
+class ResourceManager::PrefetchJob : public Common::Job {
+public:
+	PrefetchJob(const boost::shared_ptr<PrefetchRequest> &request) : _request(request) {
+	}
+
+	~PrefetchJob() {
+	}
+
+private:
+	boost::shared_ptr<PrefetchRequest> _request;
+
+	void run() {
+		if (_request->readAhead) {
+			readAhead(*_request);
+			return;
+		}
+
+		// Nobody's interested in this resource anymore
+		if (_request.unique())
+			return;
+
+		read(*_request);
+	}
+
+	/** Hand the request back to its owner, so that take() reads it itself. */
+	void discard() {
+		Common::StackLock lock(_request->mutex);
+
+		_request->queued = false;
+		_request->ready.signal();
+	}
+
+	/** Put a freshly read resource into the payload cache. */
+	static Common::SeekableReadStream *cache(const PrefetchRequest &request, Common::SeekableReadStream *stream) {
+		if (!stream || !request.cache || !request.cache->isEnabled())
+			return stream;
+
+		const Resource &res = request.resource;
+
+		return request.cache->add(res.archive, res.archiveIndex, res.path, stream);
+	}
+
+	static void read(PrefetchRequest &request) {
+		Common::SeekableReadStream *stream = 0;
+
+		bool              failed = false;
+		Common::Exception error;
+
+		try {
+			uint64 readStart = getMicroseconds();
+
+			stream = ResMan.readResource(request.resource);
+
+			ResMan.countRead(request.resource, stream, getMicroseconds() - readStart);
+
+			stream = cache(request, stream);
+		} catch (Common::Exception &e) {
+			failed = true;
+			error  = e;
+		}
+
+		Common::StackLock lock(request.mutex);
+
+		request.stream = stream;
+		request.failed = failed;
+		request.error  = error;
+		request.done   = true;
+
+		request.ready.signal();
+	}
+
+	/** Read a resource only to have it cached, and throw it away again. */
+	static void readAhead(PrefetchRequest &request) {
+		Common::SeekableReadStream *stream = 0;
+
+		try {
+			stream = cache(request, ResMan.readResource(request.resource));
+
+			// Read through the data, so that memory mapped pages are loaded from disk
+			if (stream) {
+				byte buffer[4096];
+				while (stream->read(buffer, sizeof(buffer)) == sizeof(buffer))
+					;
+			}
+
+		} catch (Common::Exception &) {
+			// It's only a hint. If it's broken, the actual request will complain
+		}
+
+		delete stream;
+	}
+};
+
+
+ResourceManager::PrefetchHandle::PrefetchHandle() {
+}
+
+ResourceManager::PrefetchHandle::PrefetchHandle(const boost::shared_ptr<PrefetchRequest> &request) :
+	_request(request) {
+}
+
+bool ResourceManager::PrefetchHandle::empty() const {
+	return !_request;
+}
+
+bool ResourceManager::PrefetchHandle::isReady() const {
+	if (!_request)
+		return true;
+
+	Common::StackLock lock(_request->mutex);
+
+	return !_request->queued || _request->done;
+}
+
+Common::SeekableReadStream *ResourceManager::PrefetchHandle::take() {
+	if (!_request)
+		return 0;
+
+	PrefetchRequest &request = *_request;
+
+	request.mutex.lock();
+
+	if (request.taken) {
+		request.mutex.unlock();
+		return 0;
+	}
+
+	request.taken = true;
+
+	while (request.queued && !request.done)
+		request.ready.wait();
+
+	bool queued = request.queued;
+	bool failed = request.failed;
+
+	Common::SeekableReadStream *stream = request.stream;
+	request.stream = 0;
+
+	request.mutex.unlock();
+
+	if (failed)
+		throw request.error;
+
+	// Not read in the background, so read it now
+	if (!queued)
+		return ResMan.getResource(request.name, request.type);
+
+	return stream;
+}
+
+
+ResourceManager::ResourceManager() : _rimsAreERFs(false), _archiveFilePool(kArchiveFilePoolSize),
+	_changeSetID(0), _prefetchPool(0), _tracing(false) {
+
+	rehash(kInitialBucketCount);
+
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeDDS);
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeTPC);
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeTXB);
@@ -117,11 +420,17 @@ ResourceManager::ResourceManager() : _rimsAreERFs(false) {
 ResourceManager::~ResourceManager() {
 	clear();
 
+	delete _prefetchPool;
+
 	for (int i = 0; i < kResourceMAX; i++)
 		_resourceTypeTypes[i].clear();
 }
 
 void ResourceManager::clear() {
+	Common::StackWriteLock lock(_lock);
+
+	cancelPrefetches();
+
 	_rimsAreERFs = false;
 
 	_cursorRemap.clear();
@@ -137,7 +446,12 @@ void ResourceManager::clear() {
 		delete *archive;
 	_archives.clear();
 
+	_resourceCache.clear();
+
+	_archiveFilePool.clear();
+
 	_resources.clear();
+	rehash(kInitialBucketCount);
 
 	_typeAliases.clear();
 
@@ -145,14 +459,35 @@ void ResourceManager::clear() {
 }
 
 void ResourceManager::setRIMsAreERFs(bool rimsAreERFs) {
+	Common::StackWriteLock lock(_lock);
+
 	_rimsAreERFs = rimsAreERFs;
 }
 
 void ResourceManager::setCursorRemap(const std::vector<Common::UString> &remap) {
+	Common::StackWriteLock lock(_lock);
+
 	_cursorRemap = remap;
 }
 
+void ResourceManager::setIndexCacheDirectory(const Common::UString &dir) {
+	Common::StackWriteLock lock(_lock);
+
+	_indexCacheDir.clear();
+	if (dir.empty())
+		return;
+
+	if (!Common::FilePath::isDirectory(dir)) {
+		warning("Index cache directory \"%s\" does not exist", dir.c_str());
+		return;
+	}
+
+	_indexCacheDir = Common::FilePath::normalize(dir);
+}
+
 void ResourceManager::registerDataBaseDir(const Common::UString &path) {
+	Common::StackWriteLock lock(_lock);
+
 	// Clear, but keep the info on whether RIMs are ERFs
 	bool rimsAreERFs = _rimsAreERFs;
 	clear();
@@ -165,6 +500,8 @@ void ResourceManager::registerDataBaseDir(const Common::UString &path) {
 }
 
 void ResourceManager::addArchiveDir(ArchiveType archive, const Common::UString &dir) {
+	Common::StackWriteLock lock(_lock);
+
 	if (archive == kArchiveNDS || archive == kArchiveHERF)
 		return;
 
@@ -206,6 +543,8 @@ Common::UString ResourceManager::findArchive(const Common::UString &file,
 }
 
 bool ResourceManager::hasArchive(ArchiveType archive, const Common::UString &file) {
+	Common::StackReadLock lock(_lock);
+
 	assert((archive >= 0) && (archive < kArchiveMAX));
 
 	if (archive == kArchiveNDS)
@@ -217,22 +556,72 @@ bool ResourceManager::hasArchive(ArchiveType archive, const Common::UString &fil
 ResourceManager::ChangeID ResourceManager::addArchive(ArchiveType archive,
 		const Common::UString &file, uint32 priority) {
 
-	// NDS aren't found in resource directories, they are used /instead/ of directories
-	if (archive == kArchiveNDS) {
-		NDSFile *nds = new NDSFile(file);
+	Common::StackWriteLock lock(_lock);
+
+	std::vector<Archive *> archives;
+	loadArchive(archive, file, archives);
+
+	return indexArchives(archives, priority);
+}
+
+void ResourceManager::addArchives(ArchiveBatch &batch) {
+	Common::StackWriteLock lock(_lock);
+
+	if (batch.empty())
+		return;
 
-		ChangeID change = newChangeSet();
+	std::vector< boost::shared_ptr<ArchiveLoader> > jobs;
+	jobs.reserve(batch.size());
 
-		return indexArchive(nds, priority, change);
+	// Load the archives, on as many threads as is sensible, this one included
+	Common::WorkerPool pool(MIN<uint32>(kArchiveLoaderThreadCount, batch.size() - 1));
+	pool.start();
+
+	for (ArchiveBatch::const_iterator entry = batch.begin(); entry != batch.end(); ++entry) {
+		jobs.push_back(boost::shared_ptr<ArchiveLoader>(new ArchiveLoader(*this, entry->archive, entry->file)));
+		pool.add(jobs.back());
 	}
 
-	// HERF files are only found inside NDS files
-	if (archive == kArchiveHERF) {
-		HERFFile *herf = new HERFFile(file);
+	pool.finish();
+
+	// Add the resources, in the order of the batch
+	std::vector< boost::shared_ptr<ArchiveLoader> >::iterator job   = jobs.begin();
+	ArchiveBatch::iterator                                    entry = batch.begin();
+	for (; (job != jobs.end()) && (entry != batch.end()); ++job, ++entry) {
+		try {
+
+			if ((*job)->deferred)
+				loadArchive((*job)->archive, (*job)->file, (*job)->archives);
+			else if ((*job)->hasFailed())
+				throw (*job)->getError();
+
+		} catch (Common::Exception &e) {
+			// Throw away the archives we won't get to
+			for (; job != jobs.end(); ++job)
+				for (std::vector<Archive *>::iterator archive = (*job)->archives.begin();
+				     archive != (*job)->archives.end(); ++archive)
+					delete *archive;
+
+			throw e;
+		}
 
-		ChangeID change = newChangeSet();
+		entry->change = indexArchives((*job)->archives, entry->priority);
+	}
+}
+
+void ResourceManager::loadArchive(ArchiveType archive, const Common::UString &file,
+		std::vector<Archive *> &archives) {
+
+	// NDS aren't found in resource directories, they are used /instead/ of directories
+	if (archive == kArchiveNDS) {
+		archives.push_back(new NDSFile(file));
+		return;
+	}
 
-		return indexArchive(herf, priority, change);
+	// HERF files are only found inside NDS files
+	if (archive == kArchiveHERF) {
+		archives.push_back(new HERFFile(file));
+		return;
 	}
 
 	assert((archive >= 0) && (archive < kArchiveMAX));
@@ -244,42 +633,34 @@ ResourceManager::ChangeID ResourceManager::addArchive(ArchiveType archive,
 	if (realName.empty())
 		throw Common::Exception("No such archive file \"%s\"", file.c_str());
 
-	if (archive == kArchiveKEY)
-		return indexKEY(realName, priority);
-
-	if (archive == kArchiveERF) {
-		ERFFile *erf = new ERFFile(realName);
-
-		ChangeID change = newChangeSet();
-
-		return indexArchive(erf, priority, change);
+	if (archive == kArchiveKEY) {
+		loadKEY(realName, archives);
+		return;
 	}
 
-	if (archive == kArchiveRIM) {
-		RIMFile *rim = new RIMFile(realName);
+	if ((archive == kArchiveERF) || (archive == kArchiveRIM)) {
+		if (readIndexCache(archive, realName, archives))
+			return;
 
-		ChangeID change = newChangeSet();
+		if (archive == kArchiveERF)
+			archives.push_back(new ERFFile(realName));
+		else
+			archives.push_back(new RIMFile(realName));
 
-		return indexArchive(rim, priority, change);
+		writeIndexCache(archive, realName, std::vector<Common::UString>(),
+		                std::vector<Common::UString>(), archives);
+		return;
 	}
 
 	if (archive == kArchiveZIP) {
-		ZIPFile *zip = new ZIPFile(realName);
-
-		ChangeID change = newChangeSet();
-
-		return indexArchive(zip, priority, change);
+		archives.push_back(new ZIPFile(realName));
+		return;
 	}
 
 	if (archive == kArchiveEXE) {
-		PEFile *pe = new PEFile(realName, _cursorRemap);
-
-		ChangeID change = newChangeSet();
-
-		return indexArchive(pe, priority, change);
+		archives.push_back(new PEFile(realName, _cursorRemap));
+		return;
 	}
-
-	return ChangeID();
 }
 
 void ResourceManager::findBIFs(const KEYFile &key, std::vector<Common::UString> &bifs) {
@@ -326,7 +707,10 @@ void ResourceManager::mergeKEYBIF(const KEYFile &key, std::vector<Common::UStrin
 
 }
 
-ResourceManager::ChangeID ResourceManager::indexKEY(const Common::UString &file, uint32 priority) {
+void ResourceManager::loadKEY(const Common::UString &file, std::vector<Archive *> &archives) {
+	if (readIndexCache(kArchiveKEY, file, archives))
+		return;
+
 	KEYFile key(file);
 
 	// Search the correct BIFs
@@ -336,14 +720,152 @@ ResourceManager::ChangeID ResourceManager::indexKEY(const Common::UString &file,
 	std::vector<BIFFile *> bifFiles;
 	mergeKEYBIF(key, bifs, bifFiles);
 
+	archives.assign(bifFiles.begin(), bifFiles.end());
+
+	const KEYFile::BIFList &keyBIFs = key.getBIFs();
+	writeIndexCache(kArchiveKEY, file, std::vector<Common::UString>(keyBIFs.begin(), keyBIFs.end()),
+	                bifs, archives);
+}
+
+ResourceManager::ChangeID ResourceManager::indexArchives(const std::vector<Archive *> &archives,
+		uint32 priority) {
+
 	ChangeID change = newChangeSet();
 
-	for (std::vector<BIFFile *>::iterator bifFile = bifFiles.begin(); bifFile != bifFiles.end(); ++bifFile)
-		indexArchive(*bifFile, priority, change);
+	for (std::vector<Archive *>::const_iterator archive = archives.begin(); archive != archives.end(); ++archive)
+		indexArchive(*archive, priority, change);
 
 	return change;
 }
 
+Common::UString ResourceManager::getIndexCacheFile(const Common::UString &file) const {
+	return Common::UString::sprintf("%s/%08x.idx", _indexCacheDir.c_str(), hashName(file));
+}
+
+bool ResourceManager::readIndexCache(ArchiveType type, const Common::UString &file,
+		std::vector<Archive *> &archives) {
+
+	if (_indexCacheDir.empty())
+		return false;
+
+	Common::File cache;
+	if (!cache.open(getIndexCacheFile(file)))
+		return false;
+
+	try {
+		if ((cache.readUint32BE() != kIndexCacheID) || (cache.readUint32LE() != kIndexCacheVersion))
+			return false;
+
+		if (cache.readUint32LE() != (uint32) type)
+			return false;
+
+		Common::UString cachePath;
+		cachePath.readASCII(cache);
+
+		// Is the cache about this very archive, and has the archive not been changed since?
+		if ((cachePath != file) ||
+		    (cache.readUint32LE() != Common::FilePath::getFileSize(file)) ||
+		    (cache.readUint64LE() != Common::FilePath::getModificationTime(file)))
+			return false;
+
+		// The same for the files the archive depends on, i.e. the BIFs of a KEY
+		std::vector<Common::UString> paths;
+
+		uint32 fileCount = cache.readUint32LE();
+		if (fileCount > ((uint32) (cache.size() - cache.pos())))
+			return false;
+
+		paths.resize(fileCount);
+		for (std::vector<Common::UString>::iterator path = paths.begin(); path != paths.end(); ++path) {
+			Common::UString name;
+			name.readASCII(cache);
+			path->readASCII(cache);
+
+			if (findArchive(name, _archiveDirs[kArchiveBIF], _archiveFiles[kArchiveBIF]) != *path)
+				return false;
+
+			if ((cache.readUint32LE() != Common::FilePath::getFileSize(*path)) ||
+			    (cache.readUint64LE() != Common::FilePath::getModificationTime(*path)))
+				return false;
+		}
+
+		if (cache.err() || cache.eos())
+			throw Common::Exception(Common::kReadError);
+
+		// Recreate the archives out of their indices
+		if (type == kArchiveKEY) {
+			for (std::vector<Common::UString>::const_iterator path = paths.begin(); path != paths.end(); ++path)
+				archives.push_back(new BIFFile(*path, cache));
+		} else if (type == kArchiveERF) {
+			archives.push_back(new ERFFile(file, cache));
+		} else if (type == kArchiveRIM) {
+			archives.push_back(new RIMFile(file, cache));
+		}
+
+	} catch (Common::Exception &e) {
+		for (std::vector<Archive *>::iterator archive = archives.begin(); archive != archives.end(); ++archive)
+			delete *archive;
+		archives.clear();
+
+		e.add("Failed reading the index cache of \"%s\"", file.c_str());
+		Common::printException(e, "WARNING: ");
+		return false;
+	}
+
+	return !archives.empty();
+}
+
+void ResourceManager::writeIndexCache(ArchiveType type, const Common::UString &file,
+		const std::vector<Common::UString> &names, const std::vector<Common::UString> &paths,
+		const std::vector<Archive *> &archives) {
+
+	if (_indexCacheDir.empty())
+		return;
+
+	assert(names.size() == paths.size());
+
+	Common::UString cacheFile = getIndexCacheFile(file);
+
+	Common::DumpFile cache;
+	if (!cache.open(cacheFile)) {
+		warning("Can't open index cache file \"%s\"", cacheFile.c_str());
+		return;
+	}
+
+	try {
+		cache.writeUint32BE(kIndexCacheID);
+		cache.writeUint32LE(kIndexCacheVersion);
+		cache.writeUint32LE((uint32) type);
+
+		cache.writeString(file);
+		cache.writeByte(0);
+		cache.writeUint32LE(Common::FilePath::getFileSize(file));
+		cache.writeUint64LE(Common::FilePath::getModificationTime(file));
+
+		cache.writeUint32LE(paths.size());
+		for (uint32 i = 0; i < paths.size(); i++) {
+			cache.writeString(names[i]);
+			cache.writeByte(0);
+			cache.writeString(paths[i]);
+			cache.writeByte(0);
+
+			cache.writeUint32LE(Common::FilePath::getFileSize(paths[i]));
+			cache.writeUint64LE(Common::FilePath::getModificationTime(paths[i]));
+		}
+
+		for (std::vector<Archive *>::const_iterator archive = archives.begin(); archive != archives.end(); ++archive)
+			(*archive)->writeIndex(cache);
+
+		if (!cache.flush() || cache.err())
+			throw Common::Exception(Common::kWriteError);
+
+	} catch (Common::Exception &e) {
+		// A broken cache file will fail validation and be overwritten next time
+		e.add("Failed writing the index cache of \"%s\"", file.c_str());
+		Common::printException(e, "WARNING: ");
+	}
+}
+
 ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32 priority, ChangeID &change) {
 	_archives.push_back(archive);
 
@@ -372,6 +894,8 @@ ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32
 ResourceManager::ChangeID ResourceManager::addResourceDir(const Common::UString &dir,
 		const char *glob, int depth, uint32 priority) {
 
+	Common::StackWriteLock lock(_lock);
+
 	// Find the directory
 	Common::UString directory = Common::FilePath::findSubDirectory(_baseDir, dir, true);
 	if (directory.empty())
@@ -399,30 +923,30 @@ ResourceManager::ChangeID ResourceManager::addResourceDir(const Common::UString
 }
 
 void ResourceManager::undo(ChangeID &change) {
+	Common::StackWriteLock lock(_lock);
+
 	if (change.empty() || (change._change == _changes.end()))
 		// Nothing to do
 		return;
 
-	// Go through all changes in the resource map
-	for (std::list<ResourceChange>::iterator resChange = change._change->resources.begin();
-	     resChange != change._change->resources.end(); ++resChange) {
-
-		// Remove the resource
-		resChange->typeIt->second.erase(resChange->resIt);
+	// The archives we're about to remove might still be read from
+	if (!change._change->archives.empty())
+		cancelPrefetches();
 
-		// If the resource list is empty, remove that one too
-		if (resChange->typeIt->second.empty())
-			resChange->nameIt->second.erase(resChange->typeIt);
-
-		// And if the type map is empty too, remove that one as well
-		if (resChange->nameIt->second.empty())
-			_resources.erase(resChange->nameIt);
-	}
+	// Remove all resources added by this change set
+	for (std::vector<uint32>::const_iterator hash = change._change->resources.begin();
+	     hash != change._change->resources.end(); ++hash)
+		removeResources(*hash, change._change->id);
 
 	// Removing all changes in the archive list
 	for (std::list<ArchiveList::iterator>::iterator archiveChange = change._change->archives.begin();
 	     archiveChange != change._change->archives.end(); ++archiveChange) {
 
+		_resourceCache.removeArchive(**archiveChange);
+
+		// Don't keep the file open, it might get replaced on disk
+		_archiveFilePool.close((**archiveChange)->getName());
+
 		delete **archiveChange;
 		_archives.erase(*archiveChange);
 	}
@@ -436,10 +960,14 @@ void ResourceManager::undo(ChangeID &change) {
 }
 
 void ResourceManager::addTypeAlias(FileType alias, FileType realType) {
+	Common::StackWriteLock lock(_lock);
+
 	_typeAliases[alias] = realType;
 }
 
 void ResourceManager::blacklist(const Common::UString &name, FileType type) {
+	Common::StackWriteLock lock(_lock);
+
 	std::vector<FileType> types(1, type);
 
 	// Get the resource list for this resource type
@@ -462,6 +990,8 @@ bool ResourceManager::hasResource(const Common::UString &name, FileType type) co
 }
 
 bool ResourceManager::hasResource(const Common::UString &name, const std::vector<FileType> &types) const {
+	Common::StackReadLock lock(_lock);
+
 	if (getRes(name, types))
 		return true;
 
@@ -486,6 +1016,12 @@ Common::SeekableReadStream *ResourceManager::getArchiveResource(const Resource &
 	if ((res.archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
 		throw Common::Exception("Archive resource has no archive");
 
+	if (res.archive->isThreadSafe())
+		return res.archive->getResource(res.archiveIndex);
+
+	// Only one thread at a time may read out of this archive
+	Common::StackLock lock(_archiveMutex);
+
 	return res.archive->getResource(res.archiveIndex);
 }
 
@@ -500,7 +1036,26 @@ Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &
 Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &name,
 		const std::vector<FileType> &types, FileType *foundType) const {
 
+	return getResourceStream(name, types, foundType, true);
+}
+
+Common::SeekableReadStream *ResourceManager::getUntracedResource(const Common::UString &name, FileType type) const {
+	std::vector<FileType> types;
+
+	types.push_back(type);
+
+	return getResourceStream(name, types, 0, false);
+}
+
+Common::SeekableReadStream *ResourceManager::getResourceStream(const Common::UString &name,
+		const std::vector<FileType> &types, FileType *foundType, bool trace) const {
+
+	Common::StackReadLock lock(_lock);
+
 	const Resource *res = getRes(name, types);
+
+	countLookup(types, res);
+
 	if (!res)
 		return 0;
 
@@ -508,16 +1063,42 @@ Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &
 	if (foundType)
 		*foundType = res->type;
 
-	if        (res->source == kSourceNone) {
-		throw Common::Exception("Invalid resource source");
-	} else if (res->source == kSourceArchive) {
-		return getArchiveResource(*res);
-	} else if (res->source == kSourceFile) {
-		// Open the file and return it
+	if (trace && _tracing)
+		traceResource(name, res->type);
+
+	Common::SeekableReadStream *stream = 0;
+	if (_resourceCache.isEnabled())
+		if ((stream = _resourceCache.get(res->archive, res->archiveIndex, res->path)))
+			return stream;
+
+	uint64 readStart = getMicroseconds();
+
+	stream = readResource(*res);
+
+	countRead(*res, stream, getMicroseconds() - readStart);
+
+	if (_resourceCache.isEnabled())
+		return _resourceCache.add(res->archive, res->archiveIndex, res->path, stream);
+
+	return stream;
+}
+
+Common::SeekableReadStream *ResourceManager::readResource(const Resource &res) const {
+	if        (res.source == kSourceNone) {
+		throw Common::Exception("Invalid resource source");
+	} else if (res.source == kSourceArchive) {
+		return getArchiveResource(res);
+	} else if (res.source == kSourceFile) {
+		// Map the file, so that big loose files like TLKs don't need to be copied into memory
+		boost::shared_ptr<Common::MappedFile> mappedFile(new Common::MappedFile);
+		if (mappedFile->open(res.path))
+			return new Common::MappedReadStream(mappedFile, 0, mappedFile->size());
+
+		// If the system can't map the file, open the file and return it
 
 		Common::File *file = new Common::File;
 
-		if (!file->open(res->path)) {
+		if (!file->open(res.path)) {
 			delete file;
 			return 0;
 		}
@@ -542,32 +1123,266 @@ Common::SeekableReadStream *ResourceManager::getResource(ResourceType resType,
 	return 0;
 }
 
+ResourceManager::PrefetchHandle ResourceManager::prefetch(const Common::UString &name, FileType type) {
+	Common::StackReadLock lock(_lock);
+
+	boost::shared_ptr<PrefetchRequest> request(new PrefetchRequest(name, type));
+
+	std::vector<FileType> types;
+	types.push_back(type);
+
+	const Resource *res = getRes(name, types);
+	if (!res) {
+		countLookup(types, res);
+
+		// Nothing to read, we already know the answer
+		request->queued = true;
+		request->done   = true;
+
+		return PrefetchHandle(request);
+	}
+
+	const bool threadSafe = ((res->source == kSourceArchive) && res->archive && res->archive->isThreadSafe()) ||
+	                        (res->source == kSourceFile);
+
+	// Can't be read in the background, take() will read it through getResource()
+	if (!threadSafe || !startPrefetchPool())
+		return PrefetchHandle(request);
+
+	countLookup(types, res);
+
+	if (_tracing)
+		traceResource(name, res->type);
+
+	if (_resourceCache.isEnabled() && (request->stream = _resourceCache.get(res->archive, res->archiveIndex, res->path))) {
+		// Already in the payload cache
+		request->queued = true;
+		request->done   = true;
+
+		return PrefetchHandle(request);
+	}
+
+	request->queued   = true;
+	request->cache    = &_resourceCache;
+	request->resource = *res;
+
+	_prefetchPool->add(boost::shared_ptr<Common::Job>(new PrefetchJob(request)));
+
+	return PrefetchHandle(request);
+}
+
+void ResourceManager::prefetch(const std::list<ResourceID> &resources, std::vector<PrefetchHandle> &handles) {
+	handles.reserve(handles.size() + resources.size());
+
+	for (std::list<ResourceID>::const_iterator r = resources.begin(); r != resources.end(); ++r)
+		handles.push_back(prefetch(r->name, r->type));
+}
+
+bool ResourceManager::startPrefetchPool() {
+	Common::StackLock lock(_prefetchMutex);
+
+	if (_prefetchPool)
+		return true;
+
+	_prefetchPool = new Common::WorkerPool(1);
+
+	if (!_prefetchPool->start()) {
+		warning("Failed to create the resource prefetch thread");
+
+		delete _prefetchPool;
+		_prefetchPool = 0;
+
+		return false;
+	}
+
+	return true;
+}
+
+void ResourceManager::cancelPrefetches() {
+	if (_prefetchPool)
+		_prefetchPool->cancel();
+}
+
+void ResourceManager::startTrace() {
+	Common::StackLock lock(_traceMutex);
+
+	_trace.clear();
+	_traceSeen.clear();
+
+	_tracing = true;
+}
+
+void ResourceManager::stopTrace(const Common::UString &fileName) {
+	std::vector<ResourceID> trace;
+
+	{
+		Common::StackLock lock(_traceMutex);
+
+		if (!_tracing)
+			return;
+
+		_tracing = false;
+
+		trace.swap(_trace);
+		_traceSeen.clear();
+	}
+
+	Common::DumpFile file;
+	if (!file.open(fileName))
+		throw Common::Exception(Common::kOpenError);
+
+	file.writeUint32BE(kTraceID);
+	file.writeUint32LE(kTraceVersion);
+
+	file.writeUint32LE(trace.size());
+	for (std::vector<ResourceID>::const_iterator t = trace.begin(); t != trace.end(); ++t) {
+		file.writeString(t->name);
+		file.writeByte(0);
+		file.writeUint32LE((uint32) t->type);
+	}
+
+	if (!file.flush() || file.err())
+		throw Common::Exception(Common::kWriteError);
+
+	file.close();
+}
+
+void ResourceManager::traceResource(const Common::UString &name, FileType type) const {
+	Common::UString lowerName = name;
+	lowerName.tolower();
+
+	Common::StackLock lock(_traceMutex);
+
+	if (!_tracing)
+		return;
+
+	// Only the first request is interesting for reading ahead
+	if (!_traceSeen.insert(std::make_pair(lowerName, type)).second)
+		return;
+
+	_trace.push_back(ResourceID());
+	_trace.back().name = name;
+	_trace.back().type = type;
+}
+
+/** A resource to read ahead, see ResourceManager::replayTrace(). */
+struct ResourceManager::ReadAheadResource {
+	const Resource *resource; ///< The resource to read.
+	uint32          offset;   ///< The offset of the resource within the archive file.
+
+	Common::UString name;
+	FileType        type;
+
+	/** Sort by archive, then by the position within the archive. */
+	bool operator<(const ReadAheadResource &right) const {
+		if (resource->archive != right.resource->archive)
+			return std::less<const Archive *>()(resource->archive, right.resource->archive);
+		if (offset != right.offset)
+			return offset < right.offset;
+
+		return resource->path < right.resource->path;
+	}
+};
+
+void ResourceManager::replayTrace(const Common::UString &fileName) {
+	Common::StackReadLock lock(_lock);
+
+	Common::File file;
+	if (!file.open(fileName))
+		return;
+
+	std::vector<ReadAheadResource> resources;
+
+	try {
+		if ((file.readUint32BE() != kTraceID) || (file.readUint32LE() != kTraceVersion))
+			throw Common::Exception("Not a resource trace");
+
+		uint32 count = file.readUint32LE();
+		if (count > ((uint32) (file.size() - file.pos())))
+			throw Common::Exception("Invalid resource count %u", count);
+
+		std::vector<FileType> types(1);
+
+		resources.reserve(count);
+		for (uint32 i = 0; i < count; i++) {
+			Common::UString name;
+			name.readASCII(file);
+
+			types[0] = (FileType) file.readUint32LE();
+
+			const Resource *res = getRes(name, types);
+			if (!res)
+				continue;
+
+			ReadAheadResource resource;
+
+			resource.resource = res;
+			resource.offset   = 0;
+			resource.name     = name;
+			resource.type     = types[0];
+
+			if      ((res->source == kSourceArchive) && res->archive && res->archive->isThreadSafe())
+				resource.offset = res->archive->getResourceOffset(res->archiveIndex);
+			else if (res->source != kSourceFile)
+				// Can't be read in the background
+				continue;
+
+			resources.push_back(resource);
+		}
+
+		if (file.err() || file.eos())
+			throw Common::Exception(Common::kReadError);
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading resource trace \"%s\"", fileName.c_str());
+		Common::printException(e, "WARNING: ");
+		return;
+	}
+
+	if (resources.empty() || !startPrefetchPool())
+		return;
+
+	std::sort(resources.begin(), resources.end());
+
+	for (std::vector<ReadAheadResource>::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		boost::shared_ptr<PrefetchRequest> request(new PrefetchRequest(r->name, r->type));
+
+		request->readAhead = true;
+		request->cache     = &_resourceCache;
+		request->resource  = *r->resource;
+
+		_prefetchPool->add(boost::shared_ptr<Common::Job>(new PrefetchJob(request)));
+	}
+}
+
 void ResourceManager::getAvailableResources(FileType type,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
-		for (ResourceTypeMap::const_iterator rt = r->second.begin(); rt != r->second.end(); ++rt)
-			if (rt->first == type) {
-				list.push_back(ResourceID());
+	Common::StackReadLock lock(_lock);
 
-				list.back().name = r->first;
-				list.back().type = rt->first;
-			}
+	for (ResourceEntryList::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
+		if (r->type == type) {
+			list.push_back(ResourceID());
+
+			list.back().name = r->name;
+			list.back().type = r->type;
+		}
 
 }
 
 void ResourceManager::getAvailableResources(const std::vector<FileType> &types,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
-		for (ResourceTypeMap::const_iterator rt = r->second.begin(); rt != r->second.end(); ++rt)
-			for (std::vector<FileType>::const_iterator wt = types.begin(); wt != types.end(); ++wt)
-				if (rt->first == *wt) {
-					list.push_back(ResourceID());
+	Common::StackReadLock lock(_lock);
+
+	for (ResourceEntryList::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
+		for (std::vector<FileType>::const_iterator wt = types.begin(); wt != types.end(); ++wt)
+			if (r->type == *wt) {
+				list.push_back(ResourceID());
 
-					list.back().name = r->first;
-					list.back().type = rt->first;
-				}
+				list.back().name = r->name;
+				list.back().type = r->type;
+			}
 }
 
 void ResourceManager::getAvailableResources(ResourceType type,
@@ -576,6 +1391,31 @@ void ResourceManager::getAvailableResources(ResourceType type,
 	getAvailableResources(_resourceTypeTypes[type], list);
 }
 
+void ResourceManager::getAvailableResources(const ChangeID &change, const std::vector<FileType> &types,
+		std::list<ResourceID> &list) const {
+
+	Common::StackReadLock lock(_lock);
+
+	if (change.empty() || (change._change == _changes.end()))
+		return;
+
+	const uint32 changeSet = change._change->id;
+
+	for (ResourceEntryList::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
+		// Only look at resources where this change provides the version actually used
+		if (r->resources.empty() || (r->resources.back().changeSet != changeSet))
+			continue;
+
+		for (std::vector<FileType>::const_iterator wt = types.begin(); wt != types.end(); ++wt)
+			if (r->type == *wt) {
+				list.push_back(ResourceID());
+
+				list.back().name = r->name;
+				list.back().type = r->type;
+			}
+	}
+}
+
 void ResourceManager::addResource(Resource &resource, Common::UString name, ChangeID &change) {
 	name.tolower();
 	if (name.empty())
@@ -596,39 +1436,21 @@ void ResourceManager::addResource(Resource &resource, Common::UString name, Chan
 	if (alias != _typeAliases.end())
 		resource.type = alias->second;
 
-	ResourceMap::iterator resTypeMap = _resources.find(name);
-	if (resTypeMap == _resources.end()) {
-		// We don't yet have a resource with this name, create a new type map for it
-
-		std::pair<ResourceMap::iterator, bool> result;
+	const uint32 hash = hashResource(hashName(name), resource.type);
 
-		result = _resources.insert(std::make_pair(name, ResourceTypeMap()));
+	uint32 entry = findEntry(hash, name, resource.type);
+	if (entry == kNoEntry)
+		// We don't yet have a resource with that name and type, create a new entry for it
+		entry = addEntry(hash, name, resource.type);
 
-		resTypeMap = result.first;
-	}
-
-	ResourceTypeMap::iterator resList = resTypeMap->second.find(resource.type);
-	if (resList == resTypeMap->second.end()) {
-		// We don't yet have a resource with that name and type, create a new resource list for it
-
-		std::pair<ResourceTypeMap::iterator, bool> result;
+	resource.changeSet = change._change->id;
 
-		result = resTypeMap->second.insert(std::make_pair(resource.type, ResourceList()));
-
-		resList = result.first;
-	}
-
-	// Add the resource to the list
-	resList->second.push_back(resource);
-
-	// And sort the list by priority
-	resList->second.sort();
+	// Add the resource to the list, behind all resources of the same or lower priority
+	ResourceList &resList = _resources[entry].resources;
+	resList.insert(std::upper_bound(resList.begin(), resList.end(), resource), resource);
 
 	// Remember the resource in the change set
-	change._change->resources.push_back(ResourceChange());
-	change._change->resources.back().nameIt = resTypeMap;
-	change._change->resources.back().typeIt = resList;
-	change._change->resources.back().resIt  = --resList->second.end();
+	change._change->resources.push_back(hash);
 }
 
 void ResourceManager::addResources(const Common::FileList &files, ChangeID &change, uint32 priority) {
@@ -643,7 +1465,7 @@ void ResourceManager::addResources(const Common::FileList &files, ChangeID &chan
 	}
 }
 
-const ResourceManager::Resource *ResourceManager::getRes(Common::UString name,
+const ResourceManager::Resource *ResourceManager::getRes(const Common::UString &name,
 		const std::vector<FileType> &types) const {
 
 	// Get the correct resource list for the name and types, make sure it's not
@@ -655,30 +1477,176 @@ const ResourceManager::Resource *ResourceManager::getRes(Common::UString name,
 	return 0;
 }
 
-const ResourceManager::ResourceList *ResourceManager::getResList(Common::UString name,
+const ResourceManager::ResourceList *ResourceManager::getResList(const Common::UString &name,
 		const std::vector<FileType> &types) const {
 
-	name.tolower();
-
-	// Find the resources with the same name
-	ResourceMap::const_iterator resFamily = _resources.find(name);
-	if (resFamily == _resources.end())
-		return 0;
+	const uint32 nameHash = hashName(name);
 
 	for (std::vector<FileType>::const_iterator type = types.begin(); type != types.end(); ++type) {
-		// Find the specific resource list of the given type
-		ResourceTypeMap::const_iterator resList = resFamily->second.find(*type);
-
-		// If the list exists, and is non-empty, and has a non-blacklisted entry, return it
-		if ((resList != resFamily->second.end()) && !resList->second.empty() &&
-		    (resList->second.back().priority != 0))
-			return &resList->second;
+		// Find the specific resource list of the given name and type
+		uint32 entry = findEntry(hashResource(nameHash, *type), name, *type);
+		if (entry == kNoEntry)
+			continue;
+
+		// If the list is non-empty, and has a non-blacklisted entry, return it
+		const ResourceList &resList = _resources[entry].resources;
+		if (!resList.empty() && (resList.back().priority != 0))
+			return &resList;
 	}
 
 	return 0;
 }
 
+uint32 ResourceManager::findEntry(uint32 hash, const Common::UString &name, FileType type) const {
+	const uint32 mask = _buckets.size() - 1;
+
+	// Linear probing, until we find the entry or an empty bucket
+	for (uint32 i = hash & mask; _buckets[i].entry != kNoEntry; i = (i + 1) & mask) {
+		if (_buckets[i].hash != hash)
+			continue;
+
+		const ResourceEntry &entry = _resources[_buckets[i].entry];
+		if ((entry.type == type) && equalsName(entry.name, name))
+			return _buckets[i].entry;
+	}
+
+	return kNoEntry;
+}
+
+uint32 ResourceManager::findBucket(uint32 hash, uint32 entry) const {
+	const uint32 mask = _buckets.size() - 1;
+
+	for (uint32 i = hash & mask; _buckets[i].entry != kNoEntry; i = (i + 1) & mask)
+		if (_buckets[i].entry == entry)
+			return i;
+
+	return kNoEntry;
+}
+
+uint32 ResourceManager::addEntry(uint32 hash, const Common::UString &name, FileType type) {
+	// Keep the load factor at or below 3/4
+	if (((_resources.size() + 1) * 4) > (_buckets.size() * 3))
+		rehash(_buckets.size() * 2);
+
+	const uint32 entry = _resources.size();
+
+	_resources.push_back(ResourceEntry());
+	_resources.back().name = name;
+	_resources.back().type = type;
+	_resources.back().hash = hash;
+
+	const uint32 mask = _buckets.size() - 1;
+
+	uint32 i = hash & mask;
+	while (_buckets[i].entry != kNoEntry)
+		i = (i + 1) & mask;
+
+	_buckets[i].hash  = hash;
+	_buckets[i].entry = entry;
+
+	return entry;
+}
+
+void ResourceManager::removeEntry(uint32 bucket) {
+	const uint32 mask  = _buckets.size() - 1;
+	const uint32 entry = _buckets[bucket].entry;
+
+	// Empty the bucket, and shift back the following buckets of the same probe
+	// sequence into the hole, so that linear probing still finds them
+	_buckets[bucket].entry = kNoEntry;
+
+	uint32 hole = bucket;
+	for (uint32 i = (hole + 1) & mask; _buckets[i].entry != kNoEntry; i = (i + 1) & mask) {
+		const uint32 home = _buckets[i].hash & mask;
+
+		// Leave the bucket alone if its home lies cyclically within (hole, i]
+		if ((hole <= i) ? ((hole < home) && (home <= i)) : ((hole < home) || (home <= i)))
+			continue;
+
+		_buckets[hole] = _buckets[i];
+		_buckets[i].entry = kNoEntry;
+
+		hole = i;
+	}
+
+	// Fill the gap in the entry list with the last entry
+	const uint32 last = _resources.size() - 1;
+	if (entry != last) {
+		const uint32 lastBucket = findBucket(_resources[last].hash, last);
+		assert(lastBucket != kNoEntry);
+
+		_buckets[lastBucket].entry = entry;
+
+		_resources[entry].name.swap(_resources[last].name);
+		_resources[entry].type = _resources[last].type;
+		_resources[entry].hash = _resources[last].hash;
+		_resources[entry].resources.swap(_resources[last].resources);
+	}
+
+	_resources.pop_back();
+}
+
+void ResourceManager::removeResources(uint32 hash, uint32 changeSet) {
+	const uint32 mask = _buckets.size() - 1;
+
+	uint32 i = hash & mask;
+	while (_buckets[i].entry != kNoEntry) {
+		if (_buckets[i].hash != hash) {
+			i = (i + 1) & mask;
+			continue;
+		}
+
+		ResourceList &resList = _resources[_buckets[i].entry].resources;
+
+		for (ResourceList::iterator r = resList.begin(); r != resList.end(); )
+			if (r->changeSet == changeSet)
+				r = resList.erase(r);
+			else
+				++r;
+
+		if (!resList.empty()) {
+			i = (i + 1) & mask;
+			continue;
+		}
+
+		// The entry is now empty, so remove it. This shifts other buckets back
+		// into this one, so we need to look at this bucket again
+		removeEntry(i);
+	}
+}
+
+void ResourceManager::rehash(uint32 bucketCount) {
+	assert((bucketCount & (bucketCount - 1)) == 0);
+
+	ResourceBucket empty;
+	empty.hash  = 0;
+	empty.entry = kNoEntry;
+
+	_buckets.assign(bucketCount, empty);
+
+	const uint32 mask = bucketCount - 1;
+	for (uint32 entry = 0; entry < _resources.size(); entry++) {
+		const uint32 hash = _resources[entry].hash;
+
+		uint32 i = hash & mask;
+		while (_buckets[i].entry != kNoEntry)
+			i = (i + 1) & mask;
+
+		_buckets[i].hash  = hash;
+		_buckets[i].entry = entry;
+	}
+}
+
+bool ResourceManager::lessResourceEntry(const ResourceEntry *a, const ResourceEntry *b) {
+	if (a->name != b->name)
+		return a->name < b->name;
+
+	return a->type < b->type;
+}
+
 void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
+	Common::StackReadLock lock(_lock);
+
 	Common::DumpFile file;
 
 	if (!file.open(fileName))
@@ -687,22 +1655,28 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.writeString("                Name                 |     Size    \n");
 	file.writeString("-------------------------------------|-------------\n");
 
-	for (ResourceMap::const_iterator itName = _resources.begin(); itName != _resources.end(); ++itName) {
-		for (ResourceTypeMap::const_iterator itType = itName->second.begin(); itType != itName->second.end(); ++itType) {
-			if (itType->second.empty())
-				continue;
+	// Sort the entries by name, so that the list is easy to read
+	std::vector<const ResourceEntry *> entries;
+	entries.reserve(_resources.size());
+	for (ResourceEntryList::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
+		entries.push_back(&*r);
 
-			const Resource &resource = itType->second.back();
+	std::sort(entries.begin(), entries.end(), &lessResourceEntry);
 
-			const Common::UString &name = itName->first;
-			const Common::UString  ext  = setFileType("", resource.type);
-			const uint32           size = getResourceSize(resource);
+	for (std::vector<const ResourceEntry *>::const_iterator e = entries.begin(); e != entries.end(); ++e) {
+		if ((*e)->resources.empty())
+			continue;
 
-			const Common::UString line =
-				Common::UString::sprintf("%32s%4s | %12d\n", name.c_str(), ext.c_str(), size);
+		const Resource &resource = (*e)->resources.back();
 
-			file.writeString(line);
-		}
+		const Common::UString &name = (*e)->name;
+		const Common::UString  ext  = setFileType("", resource.type);
+		const uint32           size = getResourceSize(resource);
+
+		const Common::UString line =
+			Common::UString::sprintf("%32s%4s | %12d\n", name.c_str(), ext.c_str(), size);
+
+		file.writeString(line);
 	}
 
 	file.flush();
@@ -713,10 +1687,162 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.close();
 }
 
+void ResourceManager::countLookup(const std::vector<FileType> &types, const Resource *res) const {
+	Common::StackLock lock(_statsMutex);
+
+	// Every type before the found one was a miss
+	for (std::vector<FileType>::const_iterator type = types.begin(); type != types.end(); ++type) {
+		AccessStats &stats = _typeStats[*type];
+
+		stats.lookups++;
+		if (res && (res->type == *type))
+			break;
+
+		stats.misses++;
+	}
+}
+
+void ResourceManager::countRead(const Resource &res, Common::SeekableReadStream *stream,
+		uint64 readTime) const {
+
+	if (!stream)
+		return;
+
+	const uint64 size = stream->size();
+
+	Common::StackLock lock(_statsMutex);
+
+	_typeStats[res.type].addRead(size, readTime);
+
+	if (res.archive)
+		_archiveStats[res.archive->getName()].addRead(size, readTime);
+	else
+		_archiveStats["<files>"].addRead(size, readTime);
+}
+
+void ResourceManager::getStats(TypeStats &types, ArchiveStats &archives) const {
+	Common::StackLock lock(_statsMutex);
+
+	types    = _typeStats;
+	archives = _archiveStats;
+}
+
+void ResourceManager::resetStats() {
+	Common::StackLock lock(_statsMutex);
+
+	_typeStats.clear();
+	_archiveStats.clear();
+
+	_resourceCache.resetStats();
+}
+
+static void writeAccessStats(Common::WriteStream &out, const Common::UString &name,
+		const ResourceManager::AccessStats &stats, bool lookups) {
+
+	const uint64 average = (stats.reads > 0) ? (stats.time / stats.reads) : 0;
+
+	out.writeString(Common::UString::sprintf("%-40s |", name.c_str()));
+
+	if (lookups)
+		out.writeString(Common::UString::sprintf(" %10llu | %10llu |",
+		                (unsigned long long) stats.lookups, (unsigned long long) stats.misses));
+
+	out.writeString(Common::UString::sprintf(" %10llu | %12llu | %10llu | %8llu\n",
+	                (unsigned long long) stats.reads, (unsigned long long) stats.bytes,
+	                (unsigned long long) (stats.time / 1000), (unsigned long long) average));
+}
+
+static void writeLatencyStats(Common::WriteStream &out, const Common::UString &name,
+		const ResourceManager::AccessStats &stats) {
+
+	if (stats.reads == 0)
+		return;
+
+	out.writeString(Common::UString::sprintf("%-40s |", name.c_str()));
+
+	for (uint32 i = 0; i < ResourceManager::kLatencyBucketCount; i++)
+		out.writeString(Common::UString::sprintf(" %6llu", (unsigned long long) stats.latency[i]));
+
+	out.writeString("\n");
+}
+
+void ResourceManager::writeStats(Common::WriteStream &out) const {
+	TypeStats    types;
+	ArchiveStats archives;
+	getStats(types, archives);
+
+	ResourceCache::Stats cache;
+	_resourceCache.getStats(cache);
+
+	out.writeString("Resource accesses by type:\n\n");
+	out.writeString("                                         |    Lookups |     Misses "
+	                "|      Reads |        Bytes |  Time (ms) | Avg (us)\n");
+	out.writeString("-----------------------------------------|------------|------------"
+	                "|------------|--------------|------------|---------\n");
+
+	for (TypeStats::const_iterator t = types.begin(); t != types.end(); ++t) {
+		Common::UString name = setFileType("", t->first);
+		if (name.empty())
+			name = Common::UString::sprintf("%d", (int) t->first);
+
+		writeAccessStats(out, name, t->second, true);
+	}
+
+	out.writeString("\nResource reads by archive:\n\n");
+	out.writeString("                                         |      Reads |        Bytes |  Time (ms) | Avg (us)\n");
+	out.writeString("-----------------------------------------|------------|--------------|------------|---------\n");
+
+	for (ArchiveStats::const_iterator a = archives.begin(); a != archives.end(); ++a)
+		writeAccessStats(out, a->first, a->second, false);
+
+	out.writeString("\nRead time histogram by archive, in reads faster than (us):\n\n");
+	out.writeString(Common::UString::sprintf("%-40s |", ""));
+	for (uint32 i = 0; i < kLatencyBucketCount - 1; i++)
+		out.writeString(Common::UString::sprintf(" %6u", 16U << i));
+	out.writeString("  slower\n");
+
+	for (ArchiveStats::const_iterator a = archives.begin(); a != archives.end(); ++a)
+		writeLatencyStats(out, a->first, a->second);
+
+	out.writeString(Common::UString::sprintf("\nResource cache: %llu hits, %llu misses, %llu evictions, "
+	                "%u resources with %u of %u bytes\n", (unsigned long long) cache.hits,
+	                (unsigned long long) cache.misses, (unsigned long long) cache.evictions,
+	                cache.count, cache.size, cache.budget));
+}
+
+void ResourceManager::dumpStats(const Common::UString &fileName) const {
+	Common::DumpFile file;
+
+	if (!file.open(fileName))
+		throw Common::Exception(Common::kOpenError);
+
+	writeStats(file);
+
+	file.flush();
+
+	if (file.err())
+		throw Common::Exception("Write error");
+
+	file.close();
+}
+
+void ResourceManager::setResourceCacheBudget(uint32 budget) {
+	_resourceCache.setBudget(budget);
+}
+
+void ResourceManager::getResourceCacheStats(ResourceCache::Stats &stats) const {
+	_resourceCache.getStats(stats);
+}
+
+boost::shared_ptr<Common::File> ResourceManager::getArchiveFile(const Common::UString &file) {
+	return _archiveFilePool.get(file);
+}
+
 ResourceManager::ChangeID ResourceManager::newChangeSet() {
 	// Generate a new change set
 
 	_changes.push_back(ChangeSet());
+	_changes.back().id = _changeSetID++;
 
 	return ChangeID(--_changes.end());
 }
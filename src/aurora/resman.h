@@ -34,16 +34,25 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <set>
+
+#include <boost/shared_ptr.hpp>
 
 #include "common/types.h"
 #include "common/ustring.h"
 #include "common/singleton.h"
 #include "common/filelist.h"
+#include "common/filepool.h"
+#include "common/mutex.h"
 
 #include "aurora/types.h"
+#include "aurora/rescache.h"
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
+	class File;
+	class WorkerPool;
 }
 
 namespace Aurora {
@@ -54,6 +63,10 @@ class BIFFile;
 
 /** A resource manager holding information about and handling all request for all
  *  resources useable by the game.
+ *
+ *  The resource manager can be used from any thread. Resources are looked up
+ *  and read concurrently, while adding or removing resources waits for
+ *  exclusive access.
  */
 class ResourceManager : public Common::Singleton<ResourceManager> {
 // Type definitions
@@ -77,6 +90,8 @@ private:
 
 		uint32 priority; ///< The resource's priority over others with the same name and type.
 
+		uint32 changeSet; ///< ID of the change set that added the resource.
+
 		Source source; ///< Where can the resource be found?
 
 		// For kSourceArchive
@@ -92,23 +107,33 @@ private:
 	};
 
 	/** List of resources, sorted by priority. */
-	typedef std::list<Resource> ResourceList;
-	/** Map over resources with the same name but different type. */
-	typedef std::map<FileType, ResourceList> ResourceTypeMap;
-	/** Map over resources, indexed by name. */
-	typedef std::map<Common::UString, ResourceTypeMap> ResourceMap;
-
-	/** A change produced by a manager operation. */
-	struct ResourceChange {
-		ResourceMap::iterator     nameIt;
-		ResourceTypeMap::iterator typeIt;
-		ResourceList::iterator    resIt;
+	typedef std::vector<Resource> ResourceList;
+
+	/** All resources with the same name and type. */
+	struct ResourceEntry {
+		Common::UString name; ///< The resources' name, in lowercase.
+		FileType        type; ///< The resources' type.
+		uint32          hash; ///< Hash over the name and type.
+
+		ResourceList resources; ///< The resources, sorted by priority.
 	};
 
+	typedef std::vector<ResourceEntry> ResourceEntryList;
+
+	/** A bucket in the open addressing hash table over the resource entries. */
+	struct ResourceBucket {
+		uint32 hash;  ///< Hash over the name and type of the entry.
+		uint32 entry; ///< Index of the entry, kNoEntry if the bucket is empty.
+	};
+
+	typedef std::vector<ResourceBucket> ResourceBucketList;
+
 	/** A set of changes produced by a manager operation. */
 	struct ChangeSet {
-		std::list<ArchiveList::iterator> archives;
-		std::list<ResourceChange>        resources;
+		uint32 id; ///< Unique ID of the change set, marking its resources.
+
+		std::list<ArchiveList::iterator> archives;  ///< The archives added.
+		std::vector<uint32>              resources; ///< Hashes of the resources added.
 	};
 
 	typedef std::list<ChangeSet> ChangeSetList;
@@ -137,6 +162,76 @@ public:
 		friend class ResourceManager;
 	};
 
+	/** An archive file to be added by addArchives(). */
+	struct ArchiveBatchEntry {
+		ArchiveType     archive;  ///< The type of archive to add.
+		Common::UString file;     ///< The name of the archive file to index.
+		uint32          priority; ///< The priority of the archive's resources.
+
+		ChangeID change; ///< The changes done by adding the archive file (output).
+
+		ArchiveBatchEntry(ArchiveType a = kArchiveKEY, const Common::UString &f = "", uint32 p = 1);
+	};
+
+	typedef std::vector<ArchiveBatchEntry> ArchiveBatch;
+
+	/** The number of buckets in the read latency histograms. */
+	static const uint32 kLatencyBucketCount = 16;
+
+	/** Statistics about resource accesses. */
+	struct AccessStats {
+		uint64 lookups; ///< Number of times a resource was looked for.
+		uint64 misses;  ///< Number of times a resource was looked for, but not found.
+		uint64 reads;   ///< Number of resources read.
+		uint64 bytes;   ///< Number of bytes read.
+		uint64 time;    ///< Time spent reading, in microseconds.
+
+		/** Histogram of read times.
+		 *
+		 *  Bucket 0 counts reads faster than 16us, bucket n reads faster than
+		 *  16 * 2^n us. The last bucket counts all slower reads.
+		 */
+		uint64 latency[kLatencyBucketCount];
+
+		AccessStats();
+
+		void addRead(uint64 size, uint64 readTime);
+	};
+
+	typedef std::map<FileType, AccessStats> TypeStats;
+	typedef std::map<Common::UString, AccessStats> ArchiveStats;
+
+private:
+	struct PrefetchRequest;
+
+public:
+	/** A handle on a resource that is read in the background, see prefetch(). */
+	class PrefetchHandle {
+	public:
+		PrefetchHandle();
+
+		bool empty() const;
+
+		/** Has the resource been read yet? Never blocks. */
+		bool isReady() const;
+
+		/** Return the resource stream, waiting for it to be read if necessary.
+		 *
+		 *  The caller takes over the stream. Every handle to the same prefetch
+		 *  request only returns the stream once, and 0 afterwards.
+		 *
+		 *  @return The resource stream or 0 if the resource doesn't exist.
+		 */
+		Common::SeekableReadStream *take();
+
+	private:
+		boost::shared_ptr<PrefetchRequest> _request;
+
+		PrefetchHandle(const boost::shared_ptr<PrefetchRequest> &request);
+
+		friend class ResourceManager;
+	};
+
 	ResourceManager();
 	~ResourceManager();
 
@@ -149,6 +244,15 @@ public:
 	/** Set the array used to map cursor ID to cursor names. */
 	void setCursorRemap(const std::vector<Common::UString> &remap);
 
+	/** Set the directory where the indices of KEY, ERF and RIM archives are cached.
+	 *
+	 *  When archives are added again, their resource lists are read out of the
+	 *  cache instead of parsing the archives, unless they were modified since.
+	 *
+	 *  @param dir The cache directory. Empty to disable the index cache.
+	 */
+	void setIndexCacheDirectory(const Common::UString &dir);
+
 	/** Register a path to be the base data directory.
 	 *
 	 *  @param path The path to a base data directory.
@@ -182,6 +286,21 @@ public:
 	 */
 	ChangeID addArchive(ArchiveType archive, const Common::UString &file, uint32 priority = 1);
 
+	/** Add several archive files and all their resources to the resource manager.
+	 *
+	 *  The archive files are opened and parsed concurrently, on several threads.
+	 *  Their resources are then added in the order of the batch, with the same
+	 *  result as calling addArchive() for each entry in turn. If an archive fails
+	 *  to load, the entries before it are still added, and the exception is
+	 *  rethrown.
+	 *
+	 *  HERF archives are only loaded when their turn comes, since they usually
+	 *  are found within an NDS file added earlier.
+	 *
+	 *  @param batch The archive files to add. The change IDs are filled in.
+	 */
+	void addArchives(ArchiveBatch &batch);
+
 	/** Add a directory's contents to the resource manager.
 	 *
 	 *  Relative to the base directory.
@@ -263,21 +382,117 @@ public:
 	Common::SeekableReadStream *getResource(ResourceType resType,
 			const Common::UString &name, FileType *foundType = 0) const;
 
+	/** Return a resource, without recording it in the resource trace.
+	 *
+	 *  For background readers, whose reads say nothing about which resources
+	 *  a later load will need.
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  type The resource's type.
+	 *  @return The resource stream or 0 if the resource doesn't exist.
+	 */
+	Common::SeekableReadStream *getUntracedResource(const Common::UString &name, FileType type) const;
+
+	/** Start reading a resource in the background.
+	 *
+	 *  The resource is looked up immediately, and read on a background I/O
+	 *  thread. Resources in archives that can't be read concurrently are
+	 *  instead read by PrefetchHandle::take(). Either way, the resource is
+	 *  counted, traced and cached like one returned by getResource().
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  type The resource's type.
+	 *  @return A handle to the resource stream.
+	 */
+	PrefetchHandle prefetch(const Common::UString &name, FileType type);
+
+	/** Start reading resources in the background.
+	 *
+	 *  @param resources The resources to read.
+	 *  @param handles The handles to the resource streams, in the same order.
+	 */
+	void prefetch(const std::list<ResourceID> &resources, std::vector<PrefetchHandle> &handles);
+
+	/** Start recording which resources are requested.
+	 *
+	 *  Every resource returned by getResource() is recorded once, in the order
+	 *  of its first request.
+	 */
+	void startTrace();
+
+	/** Stop recording requested resources, and write the trace into a file. */
+	void stopTrace(const Common::UString &fileName);
+
+	/** Read the resources recorded in a trace file ahead of time.
+	 *
+	 *  The resources are read on the background I/O thread, sorted by their
+	 *  position within their archives. This turns the scattered reads of
+	 *  a later load into one sequential pass over the disk, leaving the data
+	 *  in the resource payload cache or the operating system's page cache.
+	 *  Resources that don't exist anymore are ignored.
+	 */
+	void replayTrace(const Common::UString &fileName);
+
 	/** Return a list of all available resources of the specified type. */
 	void getAvailableResources(FileType type, std::list<ResourceID> &list) const;
 	/** Return a list of all available resources of the specified type. */
 	void getAvailableResources(const std::vector<FileType> &types, std::list<ResourceID> &list) const;
 	/** Return a list of all available resources of the specified type. */
 	void getAvailableResources(ResourceType type, std::list<ResourceID> &list) const;
+	/** Return a list of all available resources of the specified type that were added by this change. */
+	void getAvailableResources(const ChangeID &change, const std::vector<FileType> &types,
+	                           std::list<ResourceID> &list) const;
 
 	/** Dump a list of all resources into a file. */
 	void dumpResourcesList(const Common::UString &fileName) const;
 
+	/** Return statistics about resource accesses, by file type and by archive.
+	 *
+	 *  Resources in plain files are counted as the archive "<files>".
+	 *  Note that reading a resource out of a plain file or a memory mapped
+	 *  archive only sets it up. The data itself is read when it's used.
+	 */
+	void getStats(TypeStats &types, ArchiveStats &archives) const;
+
+	/** Reset all statistics about resource accesses. */
+	void resetStats();
+
+	/** Write a human-readable report of all statistics about resource accesses. */
+	void writeStats(Common::WriteStream &out) const;
+
+	/** Dump a human-readable report of all statistics about resource accesses into a file. */
+	void dumpStats(const Common::UString &fileName) const;
+
+	/** Set the memory budget of the resource payload cache.
+	 *
+	 *  Resources read out of files or archives that can't be memory mapped
+	 *  are kept in memory, up to that many bytes, so that requesting them
+	 *  again doesn't need to read them again.
+	 *
+	 *  @param budget The maximum number of bytes cached. 0 disables the cache.
+	 */
+	void setResourceCacheBudget(uint32 budget);
+
+	/** Return statistics about the resource payload cache's performance. */
+	void getResourceCacheStats(ResourceCache::Stats &stats) const;
+
+	/** Return an open handle to an archive file.
+	 *
+	 *  The handle is borrowed from a pool of open archive files, and it is
+	 *  shared with other borrowers. Only use File::readAt() on it.
+	 *
+	 *  @param  file The path of the archive file.
+	 *  @return The open archive file.
+	 */
+	boost::shared_ptr<Common::File> getArchiveFile(const Common::UString &file);
+
 private:
 	bool _rimsAreERFs; ///< Are .rim files actually ERF files?
 
 	std::vector<Common::UString> _cursorRemap; ///< Cursor ID -> cursor name
 
+	Common::UString _indexCacheDir; ///< Directory of the archive index cache.
+
 	Common::UString _baseDir;     ///< The data base directory.
 
 	DirectoryList    _archiveDirs [kArchiveMAX]; ///< Archive directories.
@@ -285,35 +500,100 @@ private:
 
 	ArchiveList _archives; ///< List of currently used archives.
 
+	Common::FilePool _archiveFilePool; ///< Pool of open archive files.
+
+	mutable ResourceCache _resourceCache; ///< Cache of resource payloads.
+
+	mutable TypeStats     _typeStats;    ///< Resource access statistics by file type.
+	mutable ArchiveStats  _archiveStats; ///< Resource access statistics by archive.
+	mutable Common::Mutex _statsMutex;
+
 	std::map<FileType, FileType> _typeAliases;
 
-	ResourceMap _resources;
+	ResourceEntryList  _resources; ///< All resource entries.
+	ResourceBucketList _buckets;   ///< Hash table over the resource entries.
+
+	/** Guards everything. Lookups lock it for reading, changes for writing. */
+	mutable Common::ReadWriteLock _lock;
+	/** Serializes reads out of archives that aren't thread-safe. */
+	mutable Common::Mutex _archiveMutex;
 
 	ChangeSetList _changes;
+	uint32        _changeSetID; ///< ID of the next change set.
+
+	class PrefetchJob;
+
+	Common::WorkerPool *_prefetchPool; ///< The background I/O thread reading prefetched resources.
+	Common::Mutex       _prefetchMutex;
+
+	struct ReadAheadResource;
+
+	typedef std::set< std::pair<Common::UString, FileType> > TraceSet;
+
+	bool                            _tracing;   ///< Are requested resources recorded?
+	mutable std::vector<ResourceID> _trace;     ///< The recorded resources, in order.
+	mutable TraceSet                _traceSeen; ///< The recorded resources, by lowercase name.
+	mutable Common::Mutex           _traceMutex;
 
 	FileTypeList _resourceTypeTypes[kResourceMAX]; ///< All valid resource type file types.
 
 	Common::UString findArchive(const Common::UString &file,
 			const DirectoryList &dirs, const Common::FileList &files);
 
-	ChangeID indexKEY(const Common::UString &file, uint32 priority);
+	class ArchiveLoader;
+
+	void loadArchive(ArchiveType archive, const Common::UString &file, std::vector<Archive *> &archives);
+	void loadKEY(const Common::UString &file, std::vector<Archive *> &archives);
+
+	ChangeID indexArchives(const std::vector<Archive *> &archives, uint32 priority);
 	ChangeID indexArchive(Archive *archive, uint32 priority, ChangeID &change);
 
 	// KEY/BIF loading helpers
 	void findBIFs   (const KEYFile &key, std::vector<Common::UString> &bifs);
 	void mergeKEYBIF(const KEYFile &key, std::vector<Common::UString> &bifs, std::vector<BIFFile *> &bifFiles);
 
+	// Index cache helpers
+	Common::UString getIndexCacheFile(const Common::UString &file) const;
+	bool readIndexCache(ArchiveType type, const Common::UString &file, std::vector<Archive *> &archives);
+	void writeIndexCache(ArchiveType type, const Common::UString &file,
+			const std::vector<Common::UString> &names, const std::vector<Common::UString> &paths,
+			const std::vector<Archive *> &archives);
+
 	void addResource(Resource &resource, Common::UString name, ChangeID &change);
 	void addResources(const Common::FileList &files, ChangeID &change, uint32 priority);
 
-	const Resource *getRes(Common::UString name, const std::vector<FileType> &types) const;
-	const ResourceList *getResList(Common::UString name, const std::vector<FileType> &types) const;
+	const Resource *getRes(const Common::UString &name, const std::vector<FileType> &types) const;
+	const ResourceList *getResList(const Common::UString &name, const std::vector<FileType> &types) const;
+
+	// Resource hash table helpers
+	uint32 findEntry(uint32 hash, const Common::UString &name, FileType type) const;
+	uint32 findBucket(uint32 hash, uint32 entry) const;
+	uint32 addEntry(uint32 hash, const Common::UString &name, FileType type);
+	void removeEntry(uint32 bucket);
+	void removeResources(uint32 hash, uint32 changeSet);
+	void rehash(uint32 bucketCount);
+
+	static bool lessResourceEntry(const ResourceEntry *a, const ResourceEntry *b);
 
 	Common::SeekableReadStream *getArchiveResource(const Resource &res) const;
+	Common::SeekableReadStream *readResource(const Resource &res) const;
+
+	Common::SeekableReadStream *getResourceStream(const Common::UString &name,
+			const std::vector<FileType> &types, FileType *foundType, bool trace) const;
+
+	void countLookup(const std::vector<FileType> &types, const Resource *res) const;
+	void countRead(const Resource &res, Common::SeekableReadStream *stream, uint64 readTime) const;
+
+	void traceResource(const Common::UString &name, FileType type) const;
 
 	uint32 getResourceSize(const Resource &res) const;
 
 	ChangeID newChangeSet();
+
+	bool startPrefetchPool();
+
+	/** Stop reading prefetched resources out of archives that might go away. */
+	void cancelPrefetches();
 };
 
 } // End of namespace Aurora
@@ -28,20 +28,30 @@
  */
 
 #include "common/stream.h"
+#include "common/file.h"
+#include "common/mappedfile.h"
 #include "common/util.h"
 
 #include "aurora/rimfile.h"
 #include "aurora/error.h"
+#include "aurora/resman.h"
 
 static const uint32 kRIMID     = MKID_BE('RIM ');
 static const uint32 kVersion1  = MKID_BE('V1.0');
 
 namespace Aurora {
 
-RIMFile::RIMFile(const Common::UString &fileName) : _fileName(fileName) {
+RIMFile::RIMFile(const Common::UString &fileName) : Archive(fileName), _fileName(fileName) {
 	load();
 }
 
+RIMFile::RIMFile(const Common::UString &fileName, Common::SeekableReadStream &index) :
+	Archive(fileName), _fileName(fileName) {
+
+	map();
+	readIndex(index);
+}
+
 RIMFile::~RIMFile() {
 }
 
@@ -50,6 +60,8 @@ void RIMFile::clear() {
 }
 
 void RIMFile::load() {
+	map();
+
 	Common::File rim;
 	open(rim);
 
@@ -102,6 +114,33 @@ void RIMFile::readResList(Common::SeekableReadStream &rim, uint32 offset) {
 	}
 }
 
+void RIMFile::readIndex(Common::SeekableReadStream &index) {
+	uint32 iResCount = index.readUint32LE();
+
+	// Each resource takes up 8 bytes
+	if (iResCount > (((uint32) (index.size() - index.pos())) / 8))
+		throw Common::Exception("RIM index too short");
+
+	_iResources.resize(iResCount);
+	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		res->offset = index.readUint32LE();
+		res->size   = index.readUint32LE();
+	}
+
+	readIndexResources(index, _resources);
+}
+
+void RIMFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32LE(_iResources.size());
+
+	for (IResourceList::const_iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		index.writeUint32LE(res->offset);
+		index.writeUint32LE(res->size);
+	}
+
+	writeIndexResources(index, _resources);
+}
+
 const Archive::ResourceList &RIMFile::getResources() const {
 	return _resources;
 }
@@ -117,25 +156,37 @@ uint32 RIMFile::getResourceSize(uint32 index) const {
 	return getIResource(index).size;
 }
 
+uint32 RIMFile::getResourceOffset(uint32 index) const {
+	return getIResource(index).offset;
+}
+
 Common::SeekableReadStream *RIMFile::getResource(uint32 index) const {
 	const IResource &res = getIResource(index);
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File rim;
-	open(rim);
+	if (_mappedFile) {
+		// Hand out a view into the mapped RIM, without copying anything
+		if ((res.offset > _mappedFile->size()) || (res.size > (_mappedFile->size() - res.offset)))
+			throw Common::Exception(Common::kReadError);
 
-	if (!rim.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
+	}
 
-	Common::SeekableReadStream *resStream = rim.readStream(res.size);
+	// Borrow an open RIM file handle from the resource manager
+	boost::shared_ptr<Common::File> rim = ResMan.getArchiveFile(_fileName);
 
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
+	byte *data = new byte[res.size];
+	if (rim->readAt(res.offset, data, res.size) != res.size) {
+		delete[] data;
 		throw Common::Exception(Common::kReadError);
 	}
 
-	return resStream;
+	return new Common::MemoryReadStream(data, res.size, true);
+}
+
+bool RIMFile::isThreadSafe() const {
+	return true;
 }
 
 void RIMFile::open(Common::File &file) const {
@@ -143,4 +194,11 @@ void RIMFile::open(Common::File &file) const {
 		throw Common::Exception(Common::kOpenError);
 }
 
+void RIMFile::map() {
+	// If the system can't map the file, we'll read the resources out of it instead
+	_mappedFile.reset(new Common::MappedFile);
+	if (!_mappedFile->open(_fileName))
+		_mappedFile.reset();
+}
+
 } // End of namespace Aurora
@@ -32,6 +32,8 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 #include "common/types.h"
 #include "common/ustring.h"
 #include "common/file.h"
@@ -42,7 +44,9 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 	class File;
+	class MappedFile;
 }
 
 namespace Aurora {
@@ -51,6 +55,8 @@ namespace Aurora {
 class RIMFile : public Archive, public AuroraBase {
 public:
 	RIMFile(const Common::UString &fileName);
+	/** Recreate the RIM out of an index written by writeIndex(). */
+	RIMFile(const Common::UString &fileName, Common::SeekableReadStream &index);
 	~RIMFile();
 
 	/** Clear the resource list. */
@@ -62,9 +68,18 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
+	/** Return the offset of a resource within the archive file. */
+	uint32 getResourceOffset(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
+	/** Write an index of the RIM's resources. */
+	void writeIndex(Common::WriteStream &index) const;
+
 private:
 	/** Internal resource information. */
 	struct IResource {
@@ -83,9 +98,14 @@ private:
 	/** The name of the RIM file. */
 	Common::UString _fileName;
 
+	/** The RIM file mapped into memory, if possible. */
+	boost::shared_ptr<Common::MappedFile> _mappedFile;
+
 	void open(Common::File &file) const;
+	void map();
 
 	void load();
+	void readIndex(Common::SeekableReadStream &index);
 	void readResList(Common::SeekableReadStream &rim, uint32 offset);
 
 	const IResource &getIResource(uint32 index) const;
@@ -27,21 +27,90 @@
  *  The global talk manager for Aurora strings.
  */
 
+#include <map>
+
 #include "aurora/talkman.h"
 #include "aurora/resman.h"
+#include "aurora/gfffile.h"
 
+#include "common/util.h"
 #include "common/error.h"
 #include "common/ustring.h"
 #include "common/stream.h"
+#include "common/workerpool.h"
 
 DECLARE_SINGLETON(Aurora::TalkManager)
 
 namespace Aurora {
 
-TalkManager::TalkManager() : _gender(kGenderMale), _mainTableM(0), _mainTableF(0), _altTableM(0), _altTableF(0) {
+/** Decoding the strings used by a list of GFFs ahead of time. */
+class TalkManager::WarmUpJob : public Common::Job {
+public:
+	WarmUpJob(TalkManager &talkMan, const std::list<ResourceManager::ResourceID> &gffs) :
+		_talkMan(&talkMan), _gffs(gffs) {
+	}
+
+	~WarmUpJob() {
+	}
+
+private:
+	/** Number of GFFs to read before decoding their strings. */
+	static const uint32 kGFFsPerBatch = 64;
+
+	TalkManager *_talkMan;
+
+	std::list<ResourceManager::ResourceID> _gffs;
+
+	void run() {
+		std::vector<uint32> strRefs;
+
+		uint32 count = 0;
+		for (std::list<ResourceManager::ResourceID>::const_iterator g = _gffs.begin(); g != _gffs.end(); ++g) {
+			if (isCanceled())
+				return;
+
+			try {
+				// Keep these reads out of the resource trace, the game itself didn't ask for them
+				Common::SeekableReadStream *res = ResMan.getUntracedResource(g->name, g->type);
+				if (res) {
+					GFFFile gff(res, 0xFFFFFFFF);
+
+					gff.getStrRefs(strRefs);
+				}
+			} catch (Common::Exception &) {
+				// It's only a hint. If it's broken, the actual user will complain
+			}
+
+			if ((++count % kGFFsPerBatch) == 0)
+				readStrings(strRefs);
+		}
+
+		readStrings(strRefs);
+	}
+
+	void readStrings(std::vector<uint32> &strRefs) {
+		if (strRefs.empty() || isCanceled())
+			return;
+
+		try {
+			_talkMan->readStrings(strRefs, kGenderMale);
+			_talkMan->readStrings(strRefs, kGenderFemale);
+		} catch (Common::Exception &) {
+		}
+
+		strRefs.clear();
+	}
+};
+
+
+TalkManager::TalkManager() : _gender(kGenderMale), _mainTableM(0), _mainTableF(0), _altTableM(0), _altTableF(0),
+	_warmUpPool(0) {
 }
 
 TalkManager::~TalkManager() {
+	// Stop the warm-up before the talk tables go away
+	delete _warmUpPool;
+
 	clear();
 }
 
@@ -98,6 +167,8 @@ void TalkManager::addAltTable(const Common::UString &name) {
 }
 
 void TalkManager::removeMainTable() {
+	cancelWarmUp();
+
 	delete _mainTableM;
 	delete _mainTableF;
 
@@ -106,6 +177,8 @@ void TalkManager::removeMainTable() {
 }
 
 void TalkManager::removeAltTable() {
+	cancelWarmUp();
+
 	delete _altTableM;
 	delete _altTableF;
 
@@ -121,11 +194,11 @@ const Common::UString &TalkManager::getString(uint32 strRef, Gender gender) {
 	if (strRef == kStrRefInvalid)
 		return kEmptyString;
 
-	const TalkTable::Entry *entry = getEntry(strRef, gender);
-	if (!entry)
+	TalkTable *table = getTable(strRef, gender);
+	if (!table)
 		return kEmptyString;
 
-	return entry->text;
+	return table->getString(strRef);
 }
 
 const Common::UString &TalkManager::getSoundResRef(uint32 strRef, Gender gender) {
@@ -136,14 +209,72 @@ const Common::UString &TalkManager::getSoundResRef(uint32 strRef, Gender gender)
 	if (strRef == kStrRefInvalid)
 		return kEmptyString;
 
-	const TalkTable::Entry *entry = getEntry(strRef, gender);
-	if (!entry)
+	TalkTable *table = getTable(strRef, gender);
+	if (!table)
 		return kEmptyString;
 
-	return entry->soundResRef;
+	return table->getSoundResRef(strRef);
+}
+
+void TalkManager::getStrings(const std::vector<uint32> &strRefs, std::vector<Common::UString> &strings,
+                             Gender gender) {
+
+	if (gender == ((Gender) -1))
+		gender = _gender;
+
+	readStrings(strRefs, gender);
+
+	strings.reserve(strings.size() + strRefs.size());
+	for (std::vector<uint32>::const_iterator strRef = strRefs.begin(); strRef != strRefs.end(); ++strRef)
+		strings.push_back(getString(*strRef, gender));
+}
+
+void TalkManager::readStrings(const std::vector<uint32> &strRefs, Gender gender) {
+	// Sort the strRefs by the table they're in
+	std::map<TalkTable *, std::vector<uint32> > tables;
+
+	for (std::vector<uint32>::const_iterator s = strRefs.begin(); s != strRefs.end(); ++s) {
+		uint32 strRef = *s;
+
+		TalkTable *table = getTable(strRef, gender);
+		if (table)
+			tables[table].push_back(strRef);
+	}
+
+	for (std::map<TalkTable *, std::vector<uint32> >::const_iterator t = tables.begin(); t != tables.end(); ++t)
+		t->first->readStrings(t->second);
+}
+
+void TalkManager::warmUp(const std::list<ResourceManager::ResourceID> &gffs) {
+	if (gffs.empty())
+		return;
+
+	Common::StackLock lock(_warmUpMutex);
+
+	if (!_warmUpPool) {
+		_warmUpPool = new Common::WorkerPool(1);
+
+		if (!_warmUpPool->start()) {
+			warning("Failed to create the talk table warm-up thread");
+
+			delete _warmUpPool;
+			_warmUpPool = 0;
+
+			return;
+		}
+	}
+
+	_warmUpPool->add(boost::shared_ptr<Common::Job>(new WarmUpJob(*this, gffs)));
+}
+
+void TalkManager::cancelWarmUp() {
+	Common::StackLock lock(_warmUpMutex);
+
+	if (_warmUpPool)
+		_warmUpPool->cancel();
 }
 
-const TalkTable::Entry *TalkManager::getEntry(uint32 strRef, Gender gender) {
+TalkTable *TalkManager::getTable(uint32 &strRef, Gender gender) {
 	if (strRef == 0xFFFFFFFF)
 		return 0;
 
@@ -151,22 +282,21 @@ const TalkTable::Entry *TalkManager::getEntry(uint32 strRef, Gender gender) {
 
 	strRef &= 0x00FFFFFF;
 
-	const TalkTable::Entry *entry = 0;
 	if (alt) {
-		if ((gender == kGenderFemale) && _altTableF)
-			entry = _altTableF->getEntry(strRef);
+		if ((gender == kGenderFemale) && _altTableF && _altTableF->hasEntry(strRef))
+			return _altTableF;
 
-		if (!entry && _altTableM)
-			entry = _altTableM->getEntry(strRef);
+		if (_altTableM && _altTableM->hasEntry(strRef))
+			return _altTableM;
 	}
 
-	if (!entry && (gender == kGenderFemale) && _mainTableF)
-		entry = _mainTableF->getEntry(strRef);
+	if ((gender == kGenderFemale) && _mainTableF && _mainTableF->hasEntry(strRef))
+		return _mainTableF;
 
-	if (!entry && _mainTableM)
-		entry = _mainTableM->getEntry(strRef);
+	if (_mainTableM && _mainTableM->hasEntry(strRef))
+		return _mainTableM;
 
-	return entry;
+	return 0;
 }
 
 } // End of namespace Aurora
@@ -30,14 +30,20 @@
 #ifndef AURORA_TALKMAN_H
 #define AURORA_TALKMAN_H
 
+#include <list>
+#include <vector>
+
 #include "common/types.h"
 #include "common/singleton.h"
+#include "common/mutex.h"
 
 #include "aurora/types.h"
 #include "aurora/talktable.h"
+#include "aurora/resman.h"
 
 namespace Common {
 	class UString;
+	class WorkerPool;
 }
 
 namespace Aurora {
@@ -63,7 +69,27 @@ public:
 	const Common::UString &getString(uint32 strRef, Gender gender = (Gender) -1);
 	const Common::UString &getSoundResRef(uint32 strRef, Gender gender = (Gender) -1);
 
+	/** Resolve several strRefs at once.
+	 *
+	 *  All strings that weren't requested before are decoded together, in
+	 *  one sorted pass over the talk tables' string data.
+	 */
+	void getStrings(const std::vector<uint32> &strRefs, std::vector<Common::UString> &strings,
+	                Gender gender = (Gender) -1);
+
+	/** Decode the strings used by these GFFs in the background.
+	 *
+	 *  The GFFs are read and searched for localized strings in a background
+	 *  thread, which then decodes all strings they reference. Later requests
+	 *  for these strings are then a simple look-up.
+	 */
+	void warmUp(const std::list<ResourceManager::ResourceID> &gffs);
+	/** Stop all running and waiting warm-ups. */
+	void cancelWarmUp();
+
 private:
+	class WarmUpJob;
+
 	Gender _gender;
 
 	TalkTable *_mainTableM;
@@ -72,9 +98,16 @@ private:
 	TalkTable *_altTableM;
 	TalkTable *_altTableF;
 
-	const TalkTable::Entry *getEntry(uint32 strRef, Gender gender);
+	Common::WorkerPool *_warmUpPool; ///< The background thread decoding strings ahead of time.
+	Common::Mutex _warmUpMutex;
+
+	/** Find the table holding this strRef, and strip the strRef of its table bits. */
+	TalkTable *getTable(uint32 &strRef, Gender gender);
 
 	void addTable(const Common::UString &name, TalkTable *&m, TalkTable *&f);
+
+	/** Decode the strings of several strRefs in as few passes as possible. */
+	void readStrings(const std::vector<uint32> &strRefs, Gender gender);
 };
 
 } // End of namespace Aurora
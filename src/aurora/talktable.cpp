@@ -27,6 +27,9 @@
  *  Handling BioWare's TLKs (talk tables).
  */
 
+#include <cstring>
+#include <algorithm>
+
 #include "common/stream.h"
 #include "common/util.h"
 
@@ -37,12 +40,53 @@ static const uint32 kTLKID     = MKID_BE('TLK ');
 static const uint32 kVersion3  = MKID_BE('V3.0');
 static const uint32 kVersion4  = MKID_BE('V4.0');
 
+static const uint32 kEntrySizeV3 = 40;
+static const uint32 kEntrySizeV4 = 10;
+
 namespace Aurora {
 
-TalkTable::TalkTable(Common::SeekableReadStream *tlk) : _tlk(tlk), _stringsOffset(0) {
+/** Make sure the whole TLK is available in memory.
+ *
+ *  Memory mapped and cached resources already are, and can be used as is.
+ *  This includes loose TLK files, which the resource manager maps. Only if
+ *  that failed, the TLK is read completely into a buffer of its own.
+ */
+static Common::MemoryReadStream *loadIntoMemory(Common::SeekableReadStream *tlk) {
+	Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(tlk);
+	if (memory)
+		return memory;
+
+	try {
+		if ((tlk->size() <= 0) || !tlk->seek(0))
+			throw Common::Exception(Common::kReadError);
+
+		memory = tlk->readStream(tlk->size());
+
+		if (tlk->err() || (memory->size() != tlk->size())) {
+			delete memory;
+			throw Common::Exception(Common::kReadError);
+		}
+
+	} catch (...) {
+		delete tlk;
+		throw;
+	}
+
+	delete tlk;
+	return memory;
+}
+
+TalkTable::TalkTable(Common::SeekableReadStream *tlk) : _tlk(0), _stringsOffset(0) {
 	assert(tlk);
 
-	load();
+	_tlk = loadIntoMemory(tlk);
+
+	try {
+		load();
+	} catch (...) {
+		delete _tlk;
+		throw;
+	}
 }
 
 TalkTable::~TalkTable() {
@@ -61,7 +105,6 @@ void TalkTable::load() {
 	_language = (Language) (_tlk->readUint32LE() * 2);
 
 	uint32 stringCount = _tlk->readUint32LE();
-	_entryList.resize(stringCount);
 
 	// V4 added this field; it's right after the header in V3
 	uint32 tableOffset = 20;
@@ -70,16 +113,28 @@ void TalkTable::load() {
 
 	_stringsOffset = _tlk->readUint32LE();
 
-	// Go to the table
-	_tlk->seek(tableOffset);
-
 	try {
 
-		// Read in all the table data
+		const uint32 entrySize = (_version == kVersion3) ? kEntrySizeV3 : kEntrySizeV4;
+
+		if (((uint64) tableOffset + (uint64) stringCount * entrySize) > (uint64) _tlk->size())
+			throw Common::Exception(Common::kReadError);
+
+		// Read in all the table data in one go
+		std::vector<byte> table(stringCount * entrySize);
+
+		if (!_tlk->seek(tableOffset))
+			throw Common::Exception(Common::kSeekError);
+
+		if (!table.empty() && (_tlk->read(&table[0], table.size()) != table.size()))
+			throw Common::Exception(Common::kReadError);
+
+		_entryList.resize(stringCount);
+
 		if (_version == kVersion3)
-			readEntryTableV3();
+			readEntryTableV3(table);
 		else
-			readEntryTableV4();
+			readEntryTableV4(table);
 
 		if (_tlk->err())
 			throw Common::Exception(Common::kReadError);
@@ -91,55 +146,137 @@ void TalkTable::load() {
 
 }
 
-void TalkTable::readEntryTableV3() {
-	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry) {
-		entry->flags          = _tlk->readUint32LE();
-		entry->soundResRef.readFixedASCII(*_tlk, 16);
-		entry->volumeVariance = _tlk->readUint32LE();
-		entry->pitchVariance  = _tlk->readUint32LE();
-		entry->offset         = _tlk->readUint32LE() + _stringsOffset;
-		entry->length         = _tlk->readUint32LE();
-		entry->soundLength    = _tlk->readIEEEFloatLE();
+void TalkTable::readEntryTableV3(const std::vector<byte> &table) {
+	const byte *data = table.empty() ? 0 : &table[0];
+
+	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry, data += kEntrySizeV3) {
+		entry->flags       = READ_LE_UINT32(data);
+		std::memcpy(entry->soundResRef, data + 4, 16);
+		// Skipping the unused volume variance and pitch variance
+		entry->offset      = READ_LE_UINT32(data + 28) + _stringsOffset;
+		entry->length      = READ_LE_UINT32(data + 32);
+		entry->soundLength = convertIEEEFloat(READ_LE_UINT32(data + 36));
+		entry->soundID     = 0;
 	}
 }
 
-void TalkTable::readEntryTableV4() {
-	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry) {
-		entry->soundID = _tlk->readUint32LE();
-		entry->offset  = _tlk->readUint32LE();
-		entry->length  = _tlk->readUint16LE();
-		entry->flags   = kFlagTextPresent;
+void TalkTable::readEntryTableV4(const std::vector<byte> &table) {
+	const byte *data = table.empty() ? 0 : &table[0];
+
+	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry, data += kEntrySizeV4) {
+		entry->soundID     = READ_LE_UINT32(data);
+		entry->offset      = READ_LE_UINT32(data + 4);
+		entry->length      = READ_LE_UINT16(data + 8);
+		entry->flags       = kFlagTextPresent;
+		entry->soundLength = 0.0;
+
+		std::memset(entry->soundResRef, 0, 16);
 	}
 }
 
-void TalkTable::readString(Entry &entry) {
-	if (!entry.text.empty() || (entry.length == 0) || !(entry.flags & kFlagTextPresent))
-		// We already have the string
-		return;
+Common::UString TalkTable::readString(const Entry &entry) const {
+	Common::UString str;
+	if ((entry.length == 0) || !(entry.flags & kFlagTextPresent))
+		return str;
 
-	assert(_tlk);
-
-	if (!_tlk->seek(entry.offset))
+	if (entry.offset > (uint32) _tlk->size())
 		throw Common::Exception(Common::kSeekError);
 
+	const uint32 length = MIN<uint32>(entry.length, _tlk->size() - entry.offset);
+
+	Common::MemoryReadStream text(_tlk->getData() + entry.offset, length);
+
 	// TODO: Different encodings for different languages, probably
-	entry.text.readFixedLatin9(*_tlk, MIN<uint32>(entry.length, _tlk->size() - _tlk->pos()));
+	str.readFixedLatin9(text, length);
+
+	return str;
 }
 
 Language TalkTable::getLanguage() const {
 	return _language;
 }
 
-const TalkTable::Entry *TalkTable::getEntry(uint32 strRef) {
+bool TalkTable::hasEntry(uint32 strRef) const {
+	return strRef < _entryList.size();
+}
+
+const TalkTable::Entry *TalkTable::getEntry(uint32 strRef) const {
 	// If invalid or not loaded, return 0
 	if (strRef >= _entryList.size())
 		return 0;
 
-	Entry &entry = _entryList[strRef];
+	return &_entryList[strRef];
+}
+
+const Common::UString &TalkTable::getString(uint32 strRef) {
+	static const Common::UString kEmptyString = "";
+
+	const Entry *entry = getEntry(strRef);
+	if (!entry || (entry->length == 0) || !(entry->flags & kFlagTextPresent))
+		return kEmptyString;
+
+	Common::StackLock lock(_mutex);
+
+	StringMap::iterator str = _strings.find(strRef);
+	if (str != _strings.end())
+		// We already have the string
+		return str->second;
+
+	return _strings.insert(std::make_pair(strRef, readString(*entry))).first->second;
+}
+
+const Common::UString &TalkTable::getSoundResRef(uint32 strRef) {
+	static const Common::UString kEmptyString = "";
+
+	const Entry *entry = getEntry(strRef);
+	if (!entry || (entry->soundResRef[0] == '\0'))
+		return kEmptyString;
+
+	Common::StackLock lock(_mutex);
+
+	StringMap::iterator resRef = _soundResRefs.find(strRef);
+	if (resRef != _soundResRefs.end())
+		return resRef->second;
+
+	uint32 length = 0;
+	while ((length < 16) && (entry->soundResRef[length] != '\0'))
+		length++;
+
+	Common::UString soundResRef(entry->soundResRef, length);
+
+	return _soundResRefs.insert(std::make_pair(strRef, soundResRef)).first->second;
+}
+
+void TalkTable::readStrings(const std::vector<uint32> &strRefs) {
+	// Find all the texts we still need to decode, and sort them by where they are
+	std::vector< std::pair<uint32, uint32> > wanted;
+	wanted.reserve(strRefs.size());
+
+	_mutex.lock();
+	for (std::vector<uint32>::const_iterator strRef = strRefs.begin(); strRef != strRefs.end(); ++strRef) {
+		const Entry *entry = getEntry(*strRef);
+		if (!entry || (entry->length == 0) || !(entry->flags & kFlagTextPresent))
+			continue;
+
+		if (_strings.find(*strRef) == _strings.end())
+			wanted.push_back(std::make_pair(entry->offset, *strRef));
+	}
+	_mutex.unlock();
+
+	std::sort(wanted.begin(), wanted.end());
+	wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+	// Decode them without blocking anybody else looking up strings
+	std::vector<Common::UString> strings;
+	strings.reserve(wanted.size());
+
+	for (std::vector< std::pair<uint32, uint32> >::const_iterator w = wanted.begin(); w != wanted.end(); ++w)
+		strings.push_back(readString(_entryList[w->second]));
 
-	readString(entry);
+	Common::StackLock lock(_mutex);
 
-	return &entry;
+	for (uint32 i = 0; i < wanted.size(); i++)
+		_strings.insert(std::make_pair(wanted[i].second, strings[i]));
 }
 
 } // End of namespace Aurora
@@ -32,19 +32,29 @@
 
 #include <vector>
 
+#include <boost/unordered/unordered_map.hpp>
+
 #include "common/types.h"
 #include "common/ustring.h"
+#include "common/mutex.h"
 
 #include "aurora/types.h"
 #include "aurora/aurorafile.h"
 
 namespace Common {
 	class SeekableReadStream;
+	class MemoryReadStream;
 }
 
 namespace Aurora {
 
-/** Class to hold string resoures. */
+/** Class to hold string resoures.
+ *
+ *  The entry table is read in one go into compact, fixed-size records.
+ *  The strings themselves are only decoded when they're first requested,
+ *  straight out of the TLK data held in memory. Strings can be requested
+ *  from several threads at once.
+ */
 class TalkTable : public AuroraBase {
 public:
 	/** The entries' flags. */
@@ -56,15 +66,12 @@ public:
 
 	/** A talk resource entry. */
 	struct Entry {
-		Common::UString text;
 		uint32 offset;
 		uint32 length;
 
 		// V3
 		uint32 flags;
-		Common::UString soundResRef;
-		uint32 volumeVariance; // Unused
-		uint32 pitchVariance; // Unused
+		char soundResRef[16]; // Not necessarily 0-terminated
 		float soundLength; // In seconds
 
 		// V4
@@ -79,15 +86,29 @@ public:
 	/** Return the language of the talk table. */
 	Language getLanguage() const;
 
+	/** Does this talk table have an entry for this strRef? */
+	bool hasEntry(uint32 strRef) const;
+
 	/** Get an entry.
 	 *
 	 *  @param strRef a handle to a string (index).
 	 *  @return 0 if strRef is invalid, otherwise the Entry from the list.
 	 */
-	const Entry *getEntry(uint32 strRef);
+	const Entry *getEntry(uint32 strRef) const;
+
+	/** Return the text of an entry, or an empty string if strRef is invalid. */
+	const Common::UString &getString(uint32 strRef);
+	/** Return the sound ResRef of an entry, or an empty string if strRef is invalid. */
+	const Common::UString &getSoundResRef(uint32 strRef);
+
+	/** Decode the texts of several entries in one pass over the string data. */
+	void readStrings(const std::vector<uint32> &strRefs);
 
 private:
-	Common::SeekableReadStream *_tlk;
+	typedef boost::unordered_map<uint32, Common::UString> StringMap;
+
+	/** The whole TLK, in memory. */
+	Common::MemoryReadStream *_tlk;
 
 	uint32 _stringsOffset;
 
@@ -95,11 +116,17 @@ private:
 
 	EntryList _entryList;
 
+	StringMap _strings;       ///< The texts we already decoded.
+	StringMap _soundResRefs;  ///< The sound ResRefs we already decoded.
+
+	Common::Mutex _mutex; ///< Protects the decoded strings.
+
 	void load();
 
-	void readEntryTableV3();
-	void readEntryTableV4();
-	void readString(Entry &entry);
+	void readEntryTableV3(const std::vector<byte> &table);
+	void readEntryTableV4(const std::vector<byte> &table);
+
+	Common::UString readString(const Entry &entry) const;
 };
 
 } // End of namespace Aurora
@@ -32,6 +32,8 @@
 #include "common/util.h"
 #include "common/ustring.h"
 #include "common/filepath.h"
+#include "common/stream.h"
+#include "common/error.h"
 
 #include "aurora/util.h"
 
@@ -377,4 +379,29 @@ Common::UString getPlatformDescription(Platform platform) {
 	return names[platform];
 }
 
+uint32 getPaddedLength(const char *str, uint32 maxLength) {
+	uint32 length = 0;
+	while ((length < maxLength) && (str[length] != '\0'))
+		length++;
+
+	return length;
+}
+
+void readTable(Common::SeekableReadStream &stream, uint32 offset,
+               uint32 count, uint32 entrySize, std::vector<byte> &table) {
+
+	if (!stream.seek(offset))
+		throw Common::Exception(Common::kSeekError);
+
+	if (count > (((uint32) (stream.size() - stream.pos())) / entrySize))
+		throw Common::Exception("Table goes beyond end of file");
+
+	table.resize(count * entrySize);
+	if (table.empty())
+		return;
+
+	if (stream.read(&table[0], table.size()) != table.size())
+		throw Common::Exception(Common::kReadError);
+}
+
 } // End of namespace Aurora
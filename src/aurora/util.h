@@ -30,8 +30,16 @@
 #ifndef AURORA_UTIL_H
 #define AURORA_UTIL_H
 
+#include <vector>
+
+#include "common/types.h"
+
 #include "aurora/types.h"
 
+namespace Common {
+	class SeekableReadStream;
+}
+
 namespace Aurora {
 
 class UString;
@@ -57,6 +65,13 @@ Common::UString setFileType(const Common::UString &path, FileType type);
 /** Return the human readable string of a Platform. */
 Common::UString getPlatformDescription(Platform platform);
 
+/** Return the length of a 0-padded string of at most maxLength characters. */
+uint32 getPaddedLength(const char *str, uint32 maxLength);
+
+/** Read a table of count entries of entrySize bytes each, starting at offset, out of a stream. */
+void readTable(Common::SeekableReadStream &stream, uint32 offset,
+               uint32 count, uint32 entrySize, std::vector<byte> &table);
+
 } // End of namespace Aurora
 
 #endif // AURORA_UTIL_H
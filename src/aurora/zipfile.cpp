@@ -37,7 +37,7 @@
 
 namespace Aurora {
 
-ZIPFile::ZIPFile(const Common::UString &fileName) : _zipFile(0) {
+ZIPFile::ZIPFile(const Common::UString &fileName) : Archive(fileName), _zipFile(0) {
 	_zipFile = new Common::ZipFile(fileName);
 
 	load();
@@ -63,6 +63,10 @@ Common::SeekableReadStream *ZIPFile::getResource(uint32 index) const {
 	return _zipFile->getFile(index);
 }
 
+bool ZIPFile::isThreadSafe() const {
+	return true;
+}
+
 void ZIPFile::load() {
 	const Common::ZipFile::FileList &files = _zipFile->getFiles();
 	for (Common::ZipFile::FileList::const_iterator file = files.begin(); file != files.end(); ++file) {
@@ -64,6 +64,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Can resources be read out of the archive by several threads at once? */
+	bool isThreadSafe() const;
+
 private:
 	/** The actual zip file. */
 	Common::ZipFile *_zipFile;
@@ -0,0 +1,91 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/atom.cpp
+ *  Interned, case-insensitive names.
+ */
+
+#include "common/atom.h"
+#include "common/ustring.h"
+#include "common/mutex.h"
+#include "common/interntable.h"
+
+namespace Common {
+
+/** All (lowercase) names interned so far, each with a unique ID. */
+struct AtomTable : public InternTable<hashUStringCaseSensitive> {
+	AtomTable() {
+		// The empty name has ID 0
+		intern("");
+	}
+};
+
+static AtomTable &getAtomTable() {
+	static AtomTable atomTable;
+
+	return atomTable;
+}
+
+
+Atom::Atom() : _id(0) {
+}
+
+Atom::Atom(const UString &name) : _id(0) {
+	intern(name);
+}
+
+Atom::Atom(const char *name) : _id(0) {
+	intern(name);
+}
+
+void Atom::intern(const UString &name) {
+	if (name.empty())
+		return;
+
+	UString lowerName = name;
+	lowerName.tolower();
+
+	AtomTable &atomTable = getAtomTable();
+	StackLock lock(atomTable.mutex);
+
+	_id = atomTable.intern(lowerName);
+}
+
+const UString &Atom::getName() const {
+	AtomTable &atomTable = getAtomTable();
+	StackLock lock(atomTable.mutex);
+
+	return atomTable.getString(_id);
+}
+
+uint32 Atom::getID() const {
+	return _id;
+}
+
+bool Atom::empty() const {
+	return _id == 0;
+}
+
+} // End of namespace Common
@@ -0,0 +1,85 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/atom.h
+ *  Interned, case-insensitive names.
+ */
+
+#ifndef COMMON_ATOM_H
+#define COMMON_ATOM_H
+
+#include <cstddef>
+
+#include "common/types.h"
+
+namespace Common {
+
+class UString;
+
+/** An interned, case-insensitive name, like a resource name or a model node name.
+ *
+ *  Every name is case-folded and hashed only once, when it's interned into a
+ *  global table. Afterwards, an Atom is just the ID of that name, so comparing
+ *  and hashing Atoms is a simple integer operation. Names that only differ in
+ *  case are the same Atom.
+ *
+ *  Interned names are never removed again, so only use Atoms for names that
+ *  come from the game data, not for ever-changing generated strings.
+ */
+class Atom {
+public:
+	/** The empty name. */
+	Atom();
+	explicit Atom(const UString &name);
+	explicit Atom(const char *name);
+
+	/** Return the (lowercase) name. */
+	const UString &getName() const;
+
+	/** Return the unique ID of this name. */
+	uint32 getID() const;
+
+	/** Is this the empty name? */
+	bool empty() const;
+
+	bool operator==(const Atom &atom) const { return _id == atom._id; }
+	bool operator!=(const Atom &atom) const { return _id != atom._id; }
+	bool operator< (const Atom &atom) const { return _id <  atom._id; }
+
+private:
+	uint32 _id; ///< The ID of the name.
+
+	void intern(const UString &name);
+};
+
+struct hashAtom {
+	std::size_t operator()(const Atom &atom) const {
+		return atom.getID();
+	}
+};
+
+} // End of namespace Common
+
+#endif // COMMON_ATOM_H
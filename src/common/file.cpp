@@ -31,6 +31,15 @@
 #include "common/error.h"
 #include "common/ustring.h"
 
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#include <io.h>
+#elif defined(UNIX)
+	#include <cerrno>
+	#include <unistd.h>
+#endif
+
 namespace Common {
 
 File::File() : _handle(0), _size(-1) {
@@ -124,6 +133,59 @@ uint32 File::read(void *dataPtr, uint32 dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+uint32 File::readAt(uint32 offset, void *dataPtr, uint32 dataSize) {
+	if (!_handle)
+		return 0;
+
+#if defined(WIN32)
+	HANDLE handle = (HANDLE) _get_osfhandle(_fileno(_handle));
+
+	OVERLAPPED overlapped;
+	std::memset(&overlapped, 0, sizeof(overlapped));
+	overlapped.Offset = offset;
+
+	DWORD bytesRead = 0;
+	if (!ReadFile(handle, dataPtr, dataSize, &bytesRead, &overlapped))
+		return 0;
+
+	return bytesRead;
+#elif defined(UNIX)
+	int fd = fileno(_handle);
+
+	uint32 bytesRead = 0;
+	while (bytesRead < dataSize) {
+		ssize_t n = pread(fd, ((byte *) dataPtr) + bytesRead, dataSize - bytesRead, offset + bytesRead);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (n == 0)
+			break;
+
+		bytesRead += n;
+	}
+
+	return bytesRead;
+#else
+	// No positional reads available, so seek there and back under a lock
+	StackLock lock(_readAtMutex);
+
+	int32 curPos = pos();
+
+	if (!seek(offset))
+		return 0;
+
+	uint32 bytesRead = read(dataPtr, dataSize);
+
+	seek(curPos);
+
+	return bytesRead;
+#endif
+}
+
 
 DumpFile::DumpFile() : _handle(0), _size(-1) {
 }
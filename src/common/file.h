@@ -36,6 +36,10 @@
 #include "common/stream.h"
 #include "common/noncopyable.h"
 
+#if !defined(WIN32) && !defined(UNIX)
+	#include "common/mutex.h"
+#endif
+
 namespace Common {
 
 class UString;
@@ -85,9 +89,33 @@ public:
 	bool seek(int32 offs, int whence = SEEK_SET); // implement abstract SeekableReadStream method
 	uint32 read(void *dataPtr, uint32 dataSize);  // implement abstract SeekableReadStream method
 
+	/**
+	 * Read data from a specific position in the file.
+	 *
+	 * This doesn't depend on the stream position indicator, so several
+	 * threads can read from the same file at the same time.
+	 *
+	 * On UNIX, the stream position stays untouched. On Windows, however,
+	 * the read moves the underlying file pointer, so don't mix readAt()
+	 * with read() and seek() on the same file. Everywhere else, readAt()
+	 * falls back to seeking there and back under a lock, so concurrent
+	 * readAt() calls are still safe, but mixing them with read() and
+	 * seek() is not.
+	 *
+	 * @param  offset the position in the file to start reading at.
+	 * @param  dataPtr pointer to a buffer into which the data is read.
+	 * @param  dataSize number of bytes to be read.
+	 * @return the number of bytes which were actually read.
+	 */
+	uint32 readAt(uint32 offset, void *dataPtr, uint32 dataSize);
+
 protected:
 	std::FILE *_handle; ///< The actual file handle.
 	int32 _size;        ///< The file's size.
+
+#if !defined(WIN32) && !defined(UNIX)
+	Mutex _readAtMutex; ///< Serializes the seek-and-read fallback of readAt().
+#endif
 };
 
 /** For quickly dumping data into a file.
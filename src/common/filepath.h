@@ -63,6 +63,13 @@ public:
 	 */
 	static uint32 getFileSize(const UString &p);
 
+	/** Return a file's last modification time.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The time of the last modification, in seconds since the epoch, or 0 on error.
+	 */
+	static uint64 getModificationTime(const UString &p);
+
 	/** Return a file name's stem.
 	 *
 	 *  Example: "/path/to/file.ext" -> "file"
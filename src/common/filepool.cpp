@@ -0,0 +1,113 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/filepool.cpp
+ *  A bounded pool of open files.
+ */
+
+#include "common/filepool.h"
+#include "common/file.h"
+#include "common/error.h"
+
+namespace Common {
+
+FilePool::FilePool(uint32 capacity) : _capacity(capacity) {
+}
+
+FilePool::~FilePool() {
+	clear();
+}
+
+uint32 FilePool::getCapacity() const {
+	return _capacity;
+}
+
+void FilePool::setCapacity(uint32 capacity) {
+	StackLock lock(_mutex);
+
+	_capacity = capacity;
+
+	shrink(_capacity);
+}
+
+void FilePool::clear() {
+	StackLock lock(_mutex);
+
+	_files.clear();
+	_usage.clear();
+}
+
+void FilePool::close(const UString &fileName) {
+	StackLock lock(_mutex);
+
+	FileMap::iterator f = _files.find(fileName);
+	if (f == _files.end())
+		return;
+
+	_usage.erase(f->second.usage);
+	_files.erase(f);
+}
+
+boost::shared_ptr<File> FilePool::get(const UString &fileName) {
+	StackLock lock(_mutex);
+
+	FileMap::iterator f = _files.find(fileName);
+	if (f != _files.end()) {
+		// Mark the file as the most recently used one
+		_usage.splice(_usage.begin(), _usage, f->second.usage);
+
+		return f->second.file;
+	}
+
+	boost::shared_ptr<File> file(new File);
+	if (!file->open(fileName))
+		throw Exception(kOpenError);
+
+	// Without any capacity, just hand out the file without keeping it
+	if (_capacity == 0)
+		return file;
+
+	// Make room for the new file
+	shrink(_capacity - 1);
+
+	_usage.push_front(fileName);
+
+	PoolFile &poolFile = _files[fileName];
+
+	poolFile.file  = file;
+	poolFile.usage = _usage.begin();
+
+	return file;
+}
+
+void FilePool::shrink(uint32 size) {
+	// Drop the least recently used files
+	while (_usage.size() > size) {
+		_files.erase(_usage.back());
+		_usage.pop_back();
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,102 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/filepool.h
+ *  A bounded pool of open files.
+ */
+
+#ifndef COMMON_FILEPOOL_H
+#define COMMON_FILEPOOL_H
+
+#include <list>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/noncopyable.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+class File;
+
+/** A bounded pool of open files.
+ *
+ *  Files are opened on demand and kept open for later requests. When the
+ *  pool is full, the least recently used file is dropped from the pool.
+ *
+ *  The files are shared between all borrowers, and they remain open for as
+ *  long as a borrower still holds them, even after they were dropped from
+ *  the pool. Borrowers should therefore only use File::readAt(), which does
+ *  not depend on the shared stream position.
+ */
+class FilePool : public NonCopyable {
+public:
+	FilePool(uint32 capacity);
+	~FilePool();
+
+	/** Return the maximum number of files kept open. */
+	uint32 getCapacity() const;
+	/** Set the maximum number of files kept open. */
+	void setCapacity(uint32 capacity);
+
+	/** Close all files in the pool. */
+	void clear();
+
+	/** Drop this file from the pool. */
+	void close(const UString &fileName);
+
+	/** Return an open file, opening it if it isn't already in the pool.
+	 *
+	 *  Throws an exception if the file can't be opened.
+	 */
+	boost::shared_ptr<File> get(const UString &fileName);
+
+private:
+	typedef std::list<UString> UsageList;
+
+	/** An open file in the pool. */
+	struct PoolFile {
+		boost::shared_ptr<File> file;  ///< The open file.
+		UsageList::iterator     usage; ///< The file's position in the usage list.
+	};
+
+	typedef std::map<UString, PoolFile> FileMap;
+
+	uint32 _capacity; ///< The maximum number of files kept open.
+
+	FileMap   _files; ///< All open files.
+	UsageList _usage; ///< All open files, most recently used first.
+
+	Mutex _mutex;
+
+	void shrink(uint32 size);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_FILEPOOL_H
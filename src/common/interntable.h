@@ -0,0 +1,78 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/interntable.h
+ *  A table of interned strings.
+ */
+
+#ifndef COMMON_INTERNTABLE_H
+#define COMMON_INTERNTABLE_H
+
+#include <deque>
+#include <functional>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+/** A table of interned strings, giving every distinct string a unique, stable ID.
+ *
+ *  IDs are handed out in order, starting at 0, and strings are never removed.
+ *  Which strings are distinct is up to the Hash and Equal functors.
+ *
+ *  The table doesn't lock itself. Callers lock the mutex around intern() and
+ *  getString(), so that they can intern a whole batch of strings at once.
+ */
+template<class Hash, class Equal = std::equal_to<UString> >
+struct InternTable {
+	typedef boost::unordered_map<UString, uint32, Hash, Equal> IDMap;
+
+	Mutex mutex;
+
+	IDMap ids;
+	std::deque<UString> strings; ///< Never moves its elements, so references to strings stay valid.
+
+	/** Return the ID of this string, giving it a new one if necessary. */
+	uint32 intern(const UString &str) {
+		std::pair<typename IDMap::iterator, bool> result = ids.insert(std::make_pair(str, (uint32) strings.size()));
+		if (result.second)
+			strings.push_back(str);
+
+		return result.first->second;
+	}
+
+	/** Return the string with this ID. */
+	const UString &getString(uint32 id) const {
+		return strings[id];
+	}
+};
+
+} // End of namespace Common
+
+#endif // COMMON_INTERNTABLE_H
@@ -0,0 +1,207 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mappedfile.cpp
+ *  Read-only memory mapped files.
+ */
+
+#include "common/mappedfile.h"
+#include "common/error.h"
+#include "common/ustring.h"
+
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(UNIX)
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace Common {
+
+MappedFile::MappedFile() : _data(0), _size(0), _open(false) {
+#if defined(WIN32)
+	_fileHandle    = INVALID_HANDLE_VALUE;
+	_mappingHandle = 0;
+#endif
+}
+
+MappedFile::MappedFile(const UString &fileName) : _data(0), _size(0), _open(false) {
+#if defined(WIN32)
+	_fileHandle    = INVALID_HANDLE_VALUE;
+	_mappingHandle = 0;
+#endif
+
+	if (!open(fileName))
+		throw Exception("Can't map file \"%s\"", fileName.c_str());
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#if defined(WIN32)
+
+bool MappedFile::open(const UString &fileName) {
+	assert(!_open);
+
+	_fileHandle = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+	                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (_fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx((HANDLE) _fileHandle, &size) || (size.HighPart != 0)) {
+		close();
+		return false;
+	}
+
+	_size = size.LowPart;
+	_open = true;
+
+	// Empty files can't be mapped, but they're valid nonetheless
+	if (_size == 0)
+		return true;
+
+	_mappingHandle = CreateFileMapping((HANDLE) _fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!_mappingHandle) {
+		close();
+		return false;
+	}
+
+	_data = (const byte *) MapViewOfFile((HANDLE) _mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!_data) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mappingHandle)
+		CloseHandle((HANDLE) _mappingHandle);
+	if (_fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle((HANDLE) _fileHandle);
+
+	_fileHandle    = INVALID_HANDLE_VALUE;
+	_mappingHandle = 0;
+
+	_data = 0;
+	_size = 0;
+	_open = false;
+}
+
+#elif defined(UNIX)
+
+bool MappedFile::open(const UString &fileName) {
+	assert(!_open);
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (((uint64) st.st_size) > 0xFFFFFFFFULL)) {
+		::close(fd);
+		return false;
+	}
+
+	_size = st.st_size;
+
+	// Empty files can't be mapped, but they're valid nonetheless
+	if (_size > 0) {
+		void *data = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			::close(fd);
+
+			_size = 0;
+			return false;
+		}
+
+		_data = (const byte *) data;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	::close(fd);
+
+	_open = true;
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		munmap(const_cast<byte *>(_data), _size);
+
+	_data = 0;
+	_size = 0;
+	_open = false;
+}
+
+#else
+
+bool MappedFile::open(const UString &fileName) {
+	// No way to map files on this system
+	return false;
+}
+
+void MappedFile::close() {
+	_data = 0;
+	_size = 0;
+	_open = false;
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+	return _open;
+}
+
+const byte *MappedFile::getData() const {
+	return _data;
+}
+
+uint32 MappedFile::size() const {
+	return _size;
+}
+
+
+MappedReadStream::MappedReadStream(const boost::shared_ptr<MappedFile> &file,
+		uint32 begin, uint32 size) :
+	MemoryReadStream(file->getData() + begin, size), _file(file) {
+
+	assert(begin <= _file->size());
+	assert(size  <= (_file->size() - begin));
+}
+
+MappedReadStream::~MappedReadStream() {
+}
+
+} // End of namespace Common
@@ -0,0 +1,105 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mappedfile.h
+ *  Read-only memory mapped files.
+ */
+
+#ifndef COMMON_MAPPEDFILE_H
+#define COMMON_MAPPEDFILE_H
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/types.h"
+#include "common/stream.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+class UString;
+
+/** A whole file, mapped read-only into memory. */
+class MappedFile : public NonCopyable {
+public:
+	MappedFile();
+	MappedFile(const UString &fileName);
+	~MappedFile();
+
+	/**
+	 * Try to map the file with the given fileName.
+	 * @note Must not be called if this file already is open (i.e. if isOpen returns true).
+	 *
+	 * @param  fileName the name of the file to map
+	 * @return true if file was mapped successfully, false otherwise
+	 */
+	bool open(const UString &fileName);
+
+	/**
+	 * Unmap the file, if mapped.
+	 */
+	void close();
+
+	/**
+	 * Checks if the object mapped a file successfully.
+	 *
+	 * @return true if any file is mapped, false otherwise.
+	 */
+	bool isOpen() const;
+
+	/** Return the mapped data. */
+	const byte *getData() const;
+
+	/** Return the size of the mapped file. */
+	uint32 size() const;
+
+private:
+	const byte *_data; ///< The mapped data.
+	uint32      _size; ///< The mapped file's size.
+	bool        _open; ///< Was a file successfully mapped?
+
+#if defined(WIN32)
+	void *_fileHandle;    ///< The Win32 file handle.
+	void *_mappingHandle; ///< The Win32 file mapping handle.
+#endif
+};
+
+/**
+ * A read-only stream viewing the range [begin, begin+size) of a MappedFile.
+ *
+ * The data is not copied. Instead, the stream shares ownership of the
+ * mapping, keeping it alive for as long as the stream exists.
+ */
+class MappedReadStream : public MemoryReadStream {
+public:
+	MappedReadStream(const boost::shared_ptr<MappedFile> &file, uint32 begin, uint32 size);
+	~MappedReadStream();
+
+private:
+	boost::shared_ptr<MappedFile> _file;
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDFILE_H
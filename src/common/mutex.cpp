@@ -140,4 +140,107 @@ void Condition::signal() {
 	SDL_CondSignal(_condition);
 }
 
+void Condition::broadcast() {
+	SDL_CondBroadcast(_condition);
+}
+
+
+ReadWriteLock::ReadWriteLock() : _released(_mutex), _writer(0), _writeCount(0), _waitingWriters(0) {
+}
+
+ReadWriteLock::~ReadWriteLock() {
+	assert(_readers.empty() && (_writeCount == 0));
+}
+
+void ReadWriteLock::lockRead() {
+	StackLock lock(_mutex);
+
+	uint32 thread = SDL_ThreadID();
+
+	// Already reading, or the writer wants to read
+	ReaderMap::iterator reader = _readers.find(thread);
+	if (reader != _readers.end()) {
+		reader->second++;
+		return;
+	}
+
+	if ((_writeCount > 0) && (_writer == thread)) {
+		_readers.insert(std::make_pair(thread, 1));
+		return;
+	}
+
+	while ((_writeCount > 0) || (_waitingWriters > 0))
+		_released.wait();
+
+	_readers.insert(std::make_pair(thread, 1));
+}
+
+void ReadWriteLock::unlockRead() {
+	StackLock lock(_mutex);
+
+	ReaderMap::iterator reader = _readers.find(SDL_ThreadID());
+	assert(reader != _readers.end());
+
+	if (--reader->second > 0)
+		return;
+
+	_readers.erase(reader);
+
+	if (_readers.empty())
+		_released.broadcast();
+}
+
+void ReadWriteLock::lockWrite() {
+	StackLock lock(_mutex);
+
+	uint32 thread = SDL_ThreadID();
+
+	if ((_writeCount > 0) && (_writer == thread)) {
+		_writeCount++;
+		return;
+	}
+
+	// A reader waiting to write would wait for itself
+	assert(_readers.find(thread) == _readers.end());
+
+	_waitingWriters++;
+
+	while ((_writeCount > 0) || !_readers.empty())
+		_released.wait();
+
+	_waitingWriters--;
+
+	_writer     = thread;
+	_writeCount = 1;
+}
+
+void ReadWriteLock::unlockWrite() {
+	StackLock lock(_mutex);
+
+	assert((_writeCount > 0) && (_writer == SDL_ThreadID()));
+
+	if (--_writeCount > 0)
+		return;
+
+	_released.broadcast();
+}
+
+
+StackReadLock::StackReadLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockRead();
+}
+
+StackReadLock::~StackReadLock() {
+	_lock->unlockRead();
+}
+
+
+StackWriteLock::StackWriteLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockWrite();
+}
+
+StackWriteLock::~StackWriteLock() {
+	_lock->unlockWrite();
+}
+
 } // End of namespace Common
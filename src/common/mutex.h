@@ -30,6 +30,8 @@
 #ifndef COMMON_MUTEX_H
 #define COMMON_MUTEX_H
 
+#include <map>
+
 #include <SDL_thread.h>
 
 #include "common/types.h"
@@ -86,6 +88,7 @@ public:
 
 	bool wait(uint32 timeout = 0);
 	void signal();
+	void broadcast();
 
 private:
 	bool _ownMutex;
@@ -94,6 +97,56 @@ private:
 	SDL_cond *_condition;
 };
 
+/** A lock that is either held by many readers, or by one writer.
+ *
+ *  Like Mutex, it is recursive: a thread holding the lock may lock it again
+ *  for reading, and the writer may also lock it again for writing. Waiting
+ *  writers take precedence over new readers.
+ */
+class ReadWriteLock {
+public:
+	ReadWriteLock();
+	~ReadWriteLock();
+
+	void lockRead();
+	void unlockRead();
+
+	void lockWrite();
+	void unlockWrite();
+
+private:
+	typedef std::map<uint32, uint32> ReaderMap;
+
+	Mutex     _mutex;
+	Condition _released; ///< Signalled when the lock is released.
+
+	ReaderMap _readers; ///< The reading threads, and how often they locked.
+
+	uint32 _writer;         ///< The writing thread.
+	uint32 _writeCount;     ///< How often the writer locked.
+	uint32 _waitingWriters; ///< The number of threads waiting to write.
+};
+
+/** Convenience class that locks a ReadWriteLock for reading on creation and unlocks it on destruction. */
+class StackReadLock {
+public:
+	StackReadLock(ReadWriteLock &lock);
+	~StackReadLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
+/** Convenience class that locks a ReadWriteLock for writing on creation and unlocks it on destruction. */
+class StackWriteLock {
+public:
+	StackWriteLock(ReadWriteLock &lock);
+	~StackWriteLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
 } // End of namespace Common
 
 #endif // COMMON_MUTEX_H
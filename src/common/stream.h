@@ -684,6 +684,9 @@ public:
 
 	void setEnc(byte value) { _encbyte = value; }
 
+	/** Return the memory buffer the stream is reading from. */
+	const byte *getData() const { return _ptrOrig; }
+
 	uint32 read(void *dataPtr, uint32 dataSize);
 
 	bool eos() const { return _eos; }
@@ -49,9 +49,15 @@ bool Thread::createThread() {
 		// Already running, nothing to do
 		return true;
 
+	// Mark the thread as running right away, so that destroyThread() waits
+	// for it even if it's called before the thread got to run at all
+	_threadRunning = true;
+
 	// Try to create the thread
-	if (!(_thread = SDL_CreateThread(threadHelper, (void *) this)))
+	if (!(_thread = SDL_CreateThread(threadHelper, (void *) this))) {
+		_threadRunning = false;
 		return false;
+	}
 
 	return true;
 }
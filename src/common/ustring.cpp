@@ -33,6 +33,10 @@
 
 #include <iconv.h>
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
 #include "common/ustring.h"
 #include "common/error.h"
 #include "common/singleton.h"
@@ -41,6 +45,75 @@
 
 namespace Common {
 
+/* Only ASCII characters are ever changed in case. In UTF-8, all bytes of
+ * non-ASCII characters are >= 0x80, so they never look like ASCII letters.
+ * Case folding and case-insensitive comparisons can therefore work on the
+ * raw bytes, without decoding the UTF-8, and 16 bytes at a time with SSE2.
+ */
+
+/** Flip the case of the byte if it lies within [first, last]. */
+static inline byte flipCase(byte c, byte first, byte last) {
+	return ((c >= first) && (c <= last)) ? (c ^ 0x20) : c;
+}
+
+#if defined(__SSE2__)
+/** Flip the case of all bytes within [first, last]. */
+static inline __m128i flipCase(__m128i c, byte first, byte last) {
+	// Signed comparisons, but bytes >= 0x80 are below first anyway
+	const __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8((char) (first - 1))),
+	                                      _mm_cmplt_epi8(c, _mm_set1_epi8((char) (last  + 1))));
+
+	return _mm_xor_si128(c, _mm_and_si128(inRange, _mm_set1_epi8(0x20)));
+}
+#endif
+
+/** Flip the case of all ASCII characters within [first, last] in the data. */
+static void flipCase(byte *data, size_t length, byte first, byte last) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; (i + 16) <= length; i += 16) {
+		__m128i c = _mm_loadu_si128((const __m128i *) (data + i));
+
+		_mm_storeu_si128((__m128i *) (data + i), flipCase(c, first, last));
+	}
+#endif
+
+	for (; i < length; i++)
+		data[i] = flipCase(data[i], first, last);
+}
+
+/** Compare two UTF-8 strings, ignoring the case of ASCII characters. */
+static int compareIgnoreCase(const byte *str1, size_t length1, const byte *str2, size_t length2) {
+	const size_t length = MIN(length1, length2);
+
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; (i + 16) <= length; i += 16) {
+		__m128i c1 = flipCase(_mm_loadu_si128((const __m128i *) (str1 + i)), 'A', 'Z');
+		__m128i c2 = flipCase(_mm_loadu_si128((const __m128i *) (str2 + i)), 'A', 'Z');
+
+		// Something differs in here, let the byte-wise loop find out what
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(c1, c2)) != 0xFFFF)
+			break;
+	}
+#endif
+
+	for (; i < length; i++) {
+		byte c1 = flipCase(str1[i], 'A', 'Z');
+		byte c2 = flipCase(str2[i], 'A', 'Z');
+
+		if (c1 != c2)
+			return (c1 < c2) ? -1 : 1;
+	}
+
+	if (length1 == length2)
+		return 0;
+
+	return (length1 < length2) ? -1 : 1;
+}
+
 static int readSingleByte(SeekableReadStream &stream, uint32 &c) {
 	c = stream.readByte();
 	return 1;
@@ -160,25 +233,23 @@ DECLARE_SINGLETON(Common::ConversionManager)
 
 namespace Common {
 
-UString::UString(const UString &str) {
-	*this = str;
+UString::UString(const UString &str) : _string(str._string), _size(str._size) {
 }
 
-UString::UString(const std::string &str) {
-	*this = str;
+UString::UString(const std::string &str) : _string(str), _size(0) {
+	recalculateSize();
 }
 
-UString::UString(const char *str) {
-	*this = str;
+UString::UString(const char *str) : _string(str), _size(0) {
+	recalculateSize();
 }
 
-UString::UString(const char *str, int n) {
-	*this = std::string(str, n);
+UString::UString(const char *str, int n) : _string(str, n), _size(0) {
+	recalculateSize();
 }
 
-UString::UString(iterator sBegin, iterator sEnd) {
-	for (; sBegin != sEnd; ++sBegin)
-		*this += *sBegin;
+UString::UString(iterator sBegin, iterator sEnd) : _string(sBegin.base(), sEnd.base()), _size(0) {
+	recalculateSize();
 }
 
 UString::~UString() {
@@ -200,17 +271,19 @@ UString &UString::operator=(const std::string &str) {
 }
 
 UString &UString::operator=(const char *str) {
-	*this = std::string(str);
+	_string = str;
+
+	recalculateSize();
 
 	return *this;
 }
 
 bool UString::operator==(const UString &str) const {
-	return strcmp(str) == 0;
+	return equals(str);
 }
 
 bool UString::operator!=(const UString &str) const {
-	return strcmp(str) != 0;
+	return !equals(str);
 }
 
 bool UString::operator<(const UString &str) const {
@@ -261,15 +334,23 @@ UString &UString::operator+=(const UString &str) {
 }
 
 UString &UString::operator+=(const std::string &str) {
-	UString ustr(str);
+	// Count first, so that invalid data leaves the string untouched
+	const uint32 size = countCharacters(str.c_str(), str.c_str() + str.size());
+
+	_string += str;
+	_size   += size;
 
-	return *this += ustr;
+	return *this;
 }
 
 UString &UString::operator+=(const char *str) {
-	UString ustr(str);
+	// Count first, so that invalid data leaves the string untouched
+	const uint32 size = countCharacters(str, str + strlen(str));
+
+	_string += str;
+	_size   += size;
 
-	return *this += ustr;
+	return *this;
 }
 
 UString &UString::operator+=(uint32 c) {
@@ -286,54 +367,31 @@ UString &UString::operator+=(uint32 c) {
 }
 
 int UString::strcmp(const UString &str) const {
-	UString::iterator it1 = begin();
-	UString::iterator it2 = str.begin();
-	for (; (it1 != end()) && (it2 != str.end()); ++it1, ++it2) {
-		uint32 c1 = *it1;
-		uint32 c2 = *it2;
-
-		if (c1 < c2)
-			return -1;
-		if (c1 > c2)
-			return  1;
-	}
+	// UTF-8 sorts the same bytewise as it does by codepoints
+	int cmp = _string.compare(str._string);
 
-	if ((it1 == end()) && (it2 == str.end()))
-		return 0;
-
-	if (it1 == end())
+	if (cmp < 0)
 		return -1;
+	if (cmp > 0)
+		return  1;
 
-	return 1;
+	return 0;
 }
 
 int UString::stricmp(const UString &str) const {
-	UString::iterator it1 = begin();
-	UString::iterator it2 = str.begin();
-	for (; (it1 != end()) && (it2 != str.end()); ++it1, ++it2) {
-		uint32 c1 = tolower(*it1);
-		uint32 c2 = tolower(*it2);
-
-		if (c1 < c2)
-			return -1;
-		if (c1 > c2)
-			return  1;
-	}
-
-	if ((it1 == end()) && (it2 == str.end()))
-		return 0;
-
-	if (it1 == end())
-		return -1;
-
-	return 1;
+	return compareIgnoreCase((const byte *) _string.c_str(), _string.size(),
+	                         (const byte *) str._string.c_str(), str._string.size());
 }
 
 bool UString::equals(const UString &str) const {
-	return strcmp(str) == 0;
+	return (_size == str._size) && (_string == str._string);
 }
 
 bool UString::equalsIgnoreCase(const UString &str) const {
+	// Changing the case never changes the length of the UTF-8 data
+	if (_string.size() != str._string.size())
+		return false;
+
 	return stricmp(str) == 0;
 }
 
@@ -385,43 +443,17 @@ UString::iterator UString::findFirst(uint32 c) const {
 }
 
 bool UString::beginsWith(const UString &with) const {
-	if (with.empty())
-		return true;
-
-	if (empty())
+	if (with._string.size() > _string.size())
 		return false;
 
-	UString::iterator myIt   = begin();
-	UString::iterator withIt = with.begin();
-
-	while ((myIt != end()) && (withIt != with.end()))
-		if (*myIt++ != *withIt++)
-			return false;
-
-	if ((myIt == end()) && (withIt != with.end()))
-		return false;
-
-	return true;
+	return _string.compare(0, with._string.size(), with._string) == 0;
 }
 
 bool UString::endsWith(const UString &with) const {
-	if (with.empty())
-		return true;
-
-	if (empty())
+	if (with._string.size() > _string.size())
 		return false;
 
-	UString::iterator myIt   = --end();
-	UString::iterator withIt = --with.end();
-
-	while ((myIt != begin()) && (withIt != with.begin()))
-		if (*myIt-- != *withIt--)
-			return false;
-
-	if (withIt == with.begin())
-		return (*myIt == *withIt);
-
-	return false;
+	return _string.compare(_string.size() - with._string.size(), with._string.size(), with._string) == 0;
 }
 
 bool UString::contains(const UString &what) const {
@@ -429,24 +461,17 @@ bool UString::contains(const UString &what) const {
 }
 
 void UString::truncate(const iterator &it) {
-	UString temp;
+	_string.resize(it.base() - begin().base());
 
-	for (iterator i = begin(); i != it; ++i)
-		temp += *i;
-
-	swap(temp);
+	recalculateSize();
 }
 
 void UString::truncate(uint32 n) {
 	if (n >= _size)
 		return;
 
-	UString temp;
-
-	for (iterator it = begin(); n > 0; ++it, n--)
-		temp += *it;
-
-	swap(temp);
+	_string.resize(getPosition(n).base() - begin().base());
+	_size = n;
 }
 
 void UString::trim() {
@@ -476,7 +501,7 @@ void UString::trim() {
 		if (*itStart != ' ')
 			break;
 
-	_string = std::string(itStart.base(), itEnd.base());
+	_string.assign(itStart.base(), itEnd.base());
 	recalculateSize();
 }
 
@@ -491,7 +516,7 @@ void UString::trimLeft() {
 		if (*itStart != ' ')
 			break;
 
-	_string = std::string(itStart.base(), end().base());
+	_string.erase(0, itStart.base() - begin().base());
 	recalculateSize();
 }
 
@@ -516,7 +541,7 @@ void UString::trimRight() {
 			++itEnd;
 	}
 
-	_string = std::string(begin().base(), itEnd.base());
+	_string.resize(itEnd.base() - begin().base());
 	recalculateSize();
 }
 
@@ -555,55 +580,17 @@ void UString::replaceAll(uint32 what, uint32 with) {
 }
 
 void UString::tolower() {
-	try {
-
-		// The new string with characters replaced
-		std::string newString;
-		newString.reserve(_string.size());
-
-		// Run through the whole string
-		std::string::iterator it = _string.begin();
-		while (it != _string.end()) {
-			// Get the codepoint
-			uint32 c = utf8::next(it, _string.end());
-
-			// And append the lowercase version to the new string
-			utf8::append(UString::tolower(c), std::back_inserter(newString));
-		}
-
-		// And set the new string's contents
-		_string.swap(newString);
+	if (_string.empty())
+		return;
 
-	} catch (const std::exception &se) {
-		Exception e(se.what());
-		throw e;
-	}
+	flipCase((byte *) &_string[0], _string.size(), 'A', 'Z');
 }
 
 void UString::toupper() {
-	try {
-
-		// The new string with characters replaced
-		std::string newString;
-		newString.reserve(_string.size());
-
-		// Run through the whole string
-		std::string::iterator it = _string.begin();
-		while (it != _string.end()) {
-			// Get the codepoint
-			uint32 c = utf8::next(it, _string.end());
-
-			// And append the uppercase version to the new string
-			utf8::append(UString::toupper(c), std::back_inserter(newString));
-		}
-
-		// And set the new string's contents
-		_string.swap(newString);
+	if (_string.empty())
+		return;
 
-	} catch (const std::exception &se) {
-		Exception e(se.what());
-		throw e;
-	}
+	flipCase((byte *) &_string[0], _string.size(), 'a', 'z');
 }
 
 UString::iterator UString::getPosition(uint32 n) const {
@@ -624,18 +611,16 @@ void UString::insert(iterator pos, uint32 c) {
 		return;
 	}
 
-	UString temp;
-
-	iterator it;
-	for (it = begin(); it != pos; ++it)
-		temp += *it;
-
-	temp += c;
-
-	for ( ; it != end(); ++it)
-		temp += *it;
+	std::string encoded;
+	try {
+		utf8::append(c, std::back_inserter(encoded));
+	} catch (const std::exception &se) {
+		Exception e(se.what());
+		throw e;
+	}
 
-	swap(temp);
+	_string.insert(pos.base() - begin().base(), encoded);
+	_size++;
 }
 
 void UString::replace(iterator pos, uint32 c) {
@@ -644,36 +629,29 @@ void UString::replace(iterator pos, uint32 c) {
 		return;
 	}
 
-	UString temp;
-
-	iterator it;
-	for (it = begin(); it != pos; ++it)
-		temp += *it;
-
-	temp += c;
+	std::string encoded;
+	try {
+		utf8::append(c, std::back_inserter(encoded));
+	} catch (const std::exception &se) {
+		Exception e(se.what());
+		throw e;
+	}
 
-	for (++it; it != end(); ++it)
-		temp += *it;
+	iterator next = pos;
+	++next;
 
-	swap(temp);
+	const std::string::size_type offset = pos.base() - begin().base();
+	_string.replace(offset, next.base() - pos.base(), encoded);
 }
 
 void UString::erase(iterator from, iterator to) {
 	if (from == end())
 		return;
 
-	UString temp;
-
-	iterator it = begin();
-	for ( ; it != from; ++it)
-		temp += *it;
-
-	for ( ; it != to; ++it);
-
-	for ( ; it != end(); ++it)
-		temp += *it;
+	const std::string::size_type offset = from.base() - begin().base();
+	_string.erase(offset, to.base() - from.base());
 
-	swap(temp);
+	recalculateSize();
 }
 
 void UString::erase(iterator pos) {
@@ -694,15 +672,16 @@ void UString::split(iterator splitPoint, UString &left, UString &right, bool rem
 		return;
 	}
 
-	iterator it = begin();
-	for ( ; it != splitPoint; ++it)
-		left += *it;
+	left._string.assign(_string.begin(), splitPoint.base());
+	left.recalculateSize();
+
+	iterator it = splitPoint;
 
 	if (remove)
 		++it;
 
-	for ( ; it != end(); ++it)
-		right += *it;
+	right._string.assign(it.base(), _string.end());
+	right.recalculateSize();
 }
 
 void UString::splitTextTokens(const UString &text, std::vector<UString> &tokens) {
@@ -769,11 +748,8 @@ void UString::splitTextTokens(const UString &text, std::vector<UString> &tokens)
 UString UString::substr(iterator from, iterator to) const {
 	UString sub;
 
-	iterator it = begin();
-	for ( ; it != from; ++it);
-
-	for ( ; it != to; ++it)
-		sub += *it;
+	sub._string.assign(from.base(), to.base());
+	sub.recalculateSize();
 
 	return sub;
 }
@@ -1188,6 +1164,15 @@ void UString::recalculateSize() {
 	}
 }
 
+uint32 UString::countCharacters(const char *begin, const char *end) {
+	try {
+		return utf8::distance(begin, end);
+	} catch (const std::exception &se) {
+		Exception e(se.what());
+		throw e;
+	}
+}
+
 // NOTE: If we ever need uppercase<->lowercase mappings for non-ASCII
 //       characters: http://www.unicode.org/reports/tr21/tr21-5.html
 
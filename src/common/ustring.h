@@ -229,9 +229,15 @@ public:
 	static uint32 fromUTF16(uint16 c);
 
 private:
-	std::string _string; ///< Internal string holding the actual data.
+	/** Internal string holding the actual data.
+	 *
+	 *  Short strings, like most resource names and GFF labels, fit into
+	 *  std::string's internal buffer and don't need a heap allocation.
+	 *  Care should be taken not to needlessly create temporary copies.
+	 */
+	std::string _string;
 
-	uint32 _size;
+	uint32 _size; ///< The number of characters (not bytes) in the string.
 
 	/** Read single-byte data. */
 	void readSingleByte(SeekableReadStream &stream, std::vector<char> &data);
@@ -251,6 +257,8 @@ private:
 	static void parseColorColors(std::vector<char> &data);
 
 	void recalculateSize();
+	/** Count the characters in this range of UTF-8 bytes. */
+	static uint32 countCharacters(const char *begin, const char *end);
 };
 
 
@@ -270,8 +278,8 @@ struct hashUStringCaseSensitive {
 	std::size_t operator()(const UString &str) const {
 		std::size_t seed = 0;
 
-		for (UString::iterator it = str.begin(); it != str.end(); ++it)
-			boost::hash_combine<uint32>(seed, *it);
+		for (const char *c = str.c_str(); *c; c++)
+			boost::hash_combine<uint32>(seed, *c);
 
 		return seed;
 	}
@@ -281,13 +289,22 @@ struct hashUStringCaseInsensitive {
 	std::size_t operator()(const UString &str) const {
 		std::size_t seed = 0;
 
-		for (UString::iterator it = str.begin(); it != str.end(); ++it)
-			boost::hash_combine<uint32>(seed, UString::tolower(*it));
+		// Only ASCII is folded, and all bytes of non-ASCII UTF-8 characters are >= 0x80
+		for (const char *c = str.c_str(); *c; c++)
+			boost::hash_combine<uint32>(seed, ((*c >= 'A') && (*c <= 'Z')) ? (*c ^ 0x20) : *c);
 
 		return seed;
 	}
 };
 
+// Comparison functions
+
+struct equalsUStringCaseInsensitive {
+	bool operator()(const UString &str1, const UString &str2) const {
+		return str1.equalsIgnoreCase(str2);
+	}
+};
+
 } // End of namespace Common
 
 #endif // COMMON_USTRING_H
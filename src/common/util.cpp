@@ -34,6 +34,13 @@
 #include <cstdio>
 #include <cstdlib>
 
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/time.h>
+#endif
+
 void warning(const char *s, ...) {
 	char buf[STRINGBUFLEN];
 	va_list va;
@@ -92,6 +99,24 @@ void NORETURN_PRE error(const char *s, ...) {
 }
 
 
+uint64 getMicroseconds() {
+#if defined(WIN32)
+	LARGE_INTEGER frequency, counter;
+	if (!QueryPerformanceFrequency(&frequency) || !QueryPerformanceCounter(&counter))
+		return 0;
+
+	return (counter.QuadPart / frequency.QuadPart) * 1000000 +
+	       ((counter.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart;
+#else
+	struct timeval tv;
+	if (gettimeofday(&tv, 0) != 0)
+		return 0;
+
+	return ((uint64) tv.tv_sec) * 1000000 + tv.tv_usec;
+#endif
+}
+
+
 	// We just directly convert here because most systems have float in IEEE 754-1985
 	// format anyway. However, should we find another system that has this differently,
 	// we might have to do something more here...
@@ -121,6 +121,9 @@ void status(const char *s, ...) GCC_PRINTF(1, 2);
 
 void NORETURN_PRE error(const char *s, ...) GCC_PRINTF(1, 2) NORETURN_POST;
 
+/** Return a timestamp in microseconds, for measuring time spans. */
+uint64 getMicroseconds();
+
 float  convertIEEEFloat(uint32 data);
 double convertIEEEDouble(uint64 data);
 
@@ -0,0 +1,193 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/workerpool.cpp
+ *  A pool of worker threads working through a queue of jobs.
+ */
+
+#include <exception>
+
+#include "common/workerpool.h"
+#include "common/thread.h"
+
+namespace Common {
+
+Job::Job() : _failed(false), _canceled(false) {
+}
+
+Job::~Job() {
+}
+
+bool Job::hasFailed() const {
+	return _failed;
+}
+
+const Exception &Job::getError() const {
+	return _error;
+}
+
+void Job::discard() {
+}
+
+bool Job::isCanceled() const {
+	return _canceled;
+}
+
+void Job::execute() {
+	try {
+		run();
+	} catch (Exception &e) {
+		_failed = true;
+		_error  = e;
+	} catch (std::exception &e) {
+		_failed = true;
+		_error  = Exception("%s", e.what());
+	}
+}
+
+
+/** A thread running jobs out of its pool. */
+class WorkerPool::Worker : public Thread {
+public:
+	Worker(WorkerPool &pool) : _pool(&pool) {
+	}
+
+	~Worker() {
+		destroyThread();
+	}
+
+private:
+	WorkerPool *_pool;
+
+	void threadMethod() {
+		while (!_killThread && !_pool->_stopping)
+			_pool->runNext(100);
+	}
+};
+
+
+WorkerPool::WorkerPool(uint32 threadCount) : _threadCount(threadCount), _stopping(false), _changed(_mutex) {
+}
+
+WorkerPool::~WorkerPool() {
+	cancel();
+
+	// Wake up the idle workers, so that they stop right away
+	_mutex.lock();
+
+	_stopping = true;
+	_changed.broadcast();
+
+	_mutex.unlock();
+
+	for (std::vector<Worker *>::iterator worker = _workers.begin(); worker != _workers.end(); ++worker)
+		delete *worker;
+}
+
+bool WorkerPool::start() {
+	while (_workers.size() < _threadCount) {
+		Worker *worker = new Worker(*this);
+		if (!worker->createThread()) {
+			delete worker;
+			break;
+		}
+
+		_workers.push_back(worker);
+	}
+
+	return !_workers.empty();
+}
+
+void WorkerPool::add(const boost::shared_ptr<Job> &job) {
+	StackLock lock(_mutex);
+
+	_waiting.push_back(job);
+
+	_changed.broadcast();
+}
+
+bool WorkerPool::runNext(uint32 timeout) {
+	_mutex.lock();
+
+	if (_waiting.empty() && (timeout > 0) && !_stopping)
+		_changed.wait(timeout);
+
+	if (_waiting.empty()) {
+		_mutex.unlock();
+		return false;
+	}
+
+	_running.splice(_running.end(), _waiting, _waiting.begin());
+	JobList::iterator job = --_running.end();
+
+	_mutex.unlock();
+
+	(*job)->execute();
+
+	_mutex.lock();
+
+	_running.erase(job);
+	_changed.broadcast();
+
+	_mutex.unlock();
+
+	return true;
+}
+
+void WorkerPool::finish() {
+	while (true) {
+		// Help out while there's something to start
+		if (runNext(0))
+			continue;
+
+		StackLock lock(_mutex);
+
+		if (_running.empty() && _waiting.empty())
+			return;
+
+		_changed.wait();
+	}
+}
+
+void WorkerPool::cancel() {
+	JobList discarded;
+
+	_mutex.lock();
+
+	discarded.swap(_waiting);
+
+	for (JobList::iterator job = _running.begin(); job != _running.end(); ++job)
+		(*job)->_canceled = true;
+
+	while (!_running.empty())
+		_changed.wait();
+
+	_mutex.unlock();
+
+	for (JobList::iterator job = discarded.begin(); job != discarded.end(); ++job)
+		(*job)->discard();
+}
+
+} // End of namespace Common
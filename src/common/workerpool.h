@@ -0,0 +1,130 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey and Eclipse engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/workerpool.h
+ *  A pool of worker threads working through a queue of jobs.
+ */
+
+#ifndef COMMON_WORKERPOOL_H
+#define COMMON_WORKERPOOL_H
+
+#include <list>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/types.h"
+#include "common/noncopyable.h"
+#include "common/mutex.h"
+#include "common/error.h"
+
+namespace Common {
+
+/** A unit of work for a WorkerPool. */
+class Job : public NonCopyable {
+public:
+	Job();
+	virtual ~Job();
+
+	/** Did the job throw an exception? */
+	bool hasFailed() const;
+	/** Return the exception the job threw. */
+	const Exception &getError() const;
+
+protected:
+	/** Do the work. Exceptions are caught and recorded. */
+	virtual void run() = 0;
+
+	/** Called instead of run() when the job is thrown out of the queue before it started. */
+	virtual void discard();
+
+	/** Was the job asked to stop early? Long-running jobs should check this regularly. */
+	bool isCanceled() const;
+
+private:
+	bool      _failed; ///< Did the job throw an exception?
+	Exception _error;  ///< The exception the job threw.
+
+	volatile bool _canceled; ///< Was the job asked to stop early?
+
+	void execute();
+
+	friend class WorkerPool;
+};
+
+/** A few worker threads, working through a shared queue of jobs.
+ *
+ *  The pool can be used for a batch of jobs, where the calling thread helps
+ *  out and then waits for all jobs with finish(), or as long-lived background
+ *  threads that are fed jobs over time.
+ */
+class WorkerPool : public NonCopyable {
+public:
+	WorkerPool(uint32 threadCount);
+	/** Cancel all jobs and stop the worker threads. */
+	~WorkerPool();
+
+	/** Start the worker threads.
+	 *
+	 *  @return true if at least one worker thread is running.
+	 */
+	bool start();
+
+	/** Queue a job. The pool shares ownership of the job until it's done. */
+	void add(const boost::shared_ptr<Job> &job);
+
+	/** Work on the queued jobs in the calling thread as well, until all jobs are done. */
+	void finish();
+
+	/** Discard all waiting jobs, and ask the running ones to stop and wait for them. */
+	void cancel();
+
+private:
+	class Worker;
+
+	typedef std::list< boost::shared_ptr<Job> > JobList;
+
+	uint32 _threadCount;
+
+	std::vector<Worker *> _workers;
+
+	volatile bool _stopping; ///< Are the worker threads being stopped?
+
+	JobList _waiting; ///< Jobs nobody has started yet.
+	JobList _running; ///< Jobs that are being worked on.
+
+	Mutex     _mutex;
+	Condition _changed; ///< Broadcast when a job was added or is done.
+
+	/** Run the next waiting job, waiting up to timeout ms for one.
+	 *
+	 *  @return true if a job was run.
+	 */
+	bool runNext(uint32 timeout);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_WORKERPOOL_H
@@ -27,19 +27,390 @@
  *  ZIP file decompresssion.
  */
 
+#include <cstring>
+
+#include <list>
+#include <map>
+
 #include <boost/algorithm/string.hpp>
+#include <boost/shared_array.hpp>
 
 #include "common/zipfile.h"
 #include "common/error.h"
 #include "common/util.h"
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/mutex.h"
+#include "common/workerpool.h"
 
 #include <zlib.h>
 
+/** Files up to this size are inflated whole, at once. */
+static const uint32 kMaxWholeInflateSize = 64 * 1024;
+
+/** The size of the inflate window, which is also the size of a cached chunk. */
+static const uint32 kWindowSize = 32768;
+
+/** The minimum distance between two restart points within an inflated file. */
+static const uint32 kRestartSpan = 1024 * 1024;
+
+/** The size of the buffer compressed data is read into. */
+static const uint32 kInputBufferSize = 16384;
+
+/** The number of inflated chunks a ZIP file keeps around. */
+static const uint32 kChunkCacheSize = 64;
+
+/** The number of extra threads inflating files in ZipFile::getFileBatch(). */
+static const uint32 kInflaterThreadCount = 3;
+
 namespace Common {
 
-ZipFile::ZipFile(const UString &fileName) : _fileName(fileName) {
+/** A cache of the most recently inflated chunks of a ZIP file's files. */
+class ZipChunkCache {
+public:
+	ZipChunkCache() {
+	}
+
+	~ZipChunkCache() {
+	}
+
+	/** Copy data out of a cached chunk, if it is cached. */
+	bool get(uint32 index, uint32 chunk, uint32 offset, byte *data, uint32 size) {
+		StackLock lock(_mutex);
+
+		ChunkMap::iterator c = _chunks.find(makeKey(index, chunk));
+		if ((c == _chunks.end()) || ((offset + size) > c->second.size))
+			return false;
+
+		_usage.splice(_usage.end(), _usage, c->second.usage);
+
+		std::memcpy(data, c->second.data.get() + offset, size);
+		return true;
+	}
+
+	/** Add a chunk to the cache, throwing out the least recently used one. */
+	void add(uint32 index, uint32 chunk, const byte *data, uint32 size) {
+		StackLock lock(_mutex);
+
+		uint64 key = makeKey(index, chunk);
+		if (_chunks.find(key) != _chunks.end())
+			return;
+
+		if (_chunks.size() >= kChunkCacheSize) {
+			_chunks.erase(_usage.front());
+			_usage.pop_front();
+		}
+
+		Chunk &c = _chunks[key];
+
+		c.data.reset(new byte[size]);
+		c.size  = size;
+		c.usage = _usage.insert(_usage.end(), key);
+
+		std::memcpy(c.data.get(), data, size);
+	}
+
+private:
+	struct Chunk {
+		boost::shared_array<byte> data;
+		uint32 size;
+
+		std::list<uint64>::iterator usage;
+	};
+
+	typedef std::map<uint64, Chunk> ChunkMap;
+
+	ChunkMap          _chunks;
+	std::list<uint64> _usage; ///< The cached chunks, least recently used first.
+
+	Mutex _mutex;
+
+	static uint64 makeKey(uint32 index, uint32 chunk) {
+		return (((uint64) index) << 32) | chunk;
+	}
+};
+
+
+/** A stream inflating a compressed file within a ZIP file as it is read.
+ *
+ *  The last inflated 32KB are kept in a window. Every megabyte or so, the
+ *  state of the decompressor is remembered in a restart point, so that
+ *  seeking backwards doesn't need to start over from the beginning.
+ *  Completely inflated chunks are also put into the ZIP file's chunk cache.
+ */
+class ZipInflateStream : public SeekableReadStream {
+public:
+	ZipInflateStream(const boost::shared_ptr<Common::File> &zip, const boost::shared_ptr<ZipChunkCache> &cache,
+	                 uint32 index, uint32 offset, uint32 compSize, uint32 size) :
+		_zip(zip), _cache(cache), _index(index), _offset(offset), _compSize(compSize), _size(size),
+		_pos(0), _eos(false), _err(false), _inflating(false), _input(0), _inPos(0), _outPos(0), _window(0) {
+
+		std::memset(&_strm, 0, sizeof(_strm));
+
+		_window = new byte[kWindowSize];
+
+		_restartPoints.push_back(RestartPoint());
+	}
+
+	~ZipInflateStream() {
+		stopInflate();
+
+		delete[] _window;
+	}
+
+	bool eos() const { return _eos; }
+	bool err() const { return _err; }
+	void clearErr() { _eos = false; _err = false; }
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		if      (whence == SEEK_END)
+			offset = _size + offset;
+		else if (whence == SEEK_CUR)
+			offset = _pos + offset;
+
+		if ((offset < 0) || (((uint32) offset) > _size))
+			return false;
+
+		_pos = offset;
+		_eos = false;
+		return true;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > (_size - _pos)) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		byte  *data = (byte *) dataPtr;
+		uint32 left = dataSize;
+
+		try {
+			while (left > 0) {
+				uint32 chunk  = _pos / kWindowSize;
+				uint32 offset = _pos % kWindowSize;
+				uint32 count  = MIN(left, kWindowSize - offset);
+
+				if (!readWindow(data, count) && !_cache->get(_index, chunk, offset, data, count)) {
+					inflateTo(_pos + count);
+					continue;
+				}
+
+				data += count;
+				left -= count;
+				_pos += count;
+			}
+		} catch (Exception &) {
+			_err = true;
+		}
+
+		return dataSize - left;
+	}
+
+private:
+	/** The state of the decompressor at a deflate block boundary. */
+	struct RestartPoint {
+		uint32 out;  ///< The position within the inflated data.
+		uint32 in;   ///< The position within the compressed data.
+		int    bits; ///< The number of bits of the previous byte that still need to be inflated.
+
+		boost::shared_array<byte> window; ///< The 32KB of inflated data before this point.
+
+		RestartPoint() : out(0), in(0), bits(0) {
+		}
+	};
+
+	boost::shared_ptr<Common::File>  _zip;
+	boost::shared_ptr<ZipChunkCache> _cache;
+
+	uint32 _index;    ///< The index of the file within the ZIP.
+	uint32 _offset;   ///< The offset of the compressed data within the ZIP.
+	uint32 _compSize; ///< The size of the compressed data.
+	uint32 _size;     ///< The size of the inflated data.
+
+	uint32 _pos;
+
+	bool _eos;
+	bool _err;
+
+	z_stream _strm;
+	bool     _inflating; ///< Is _strm initialized?
+
+	byte  *_input;  ///< Compressed data buffer.
+	uint32 _inPos;  ///< The amount of compressed data read into the buffer so far.
+	uint32 _outPos; ///< The amount of data inflated so far.
+
+	/** The last inflated data, with the data at position p found at p % kWindowSize. */
+	byte *_window;
+
+	std::vector<RestartPoint> _restartPoints;
+
+	/** Copy data out of the window, if it is there. */
+	bool readWindow(byte *data, uint32 count) {
+		uint32 windowStart = (_outPos > kWindowSize) ? (_outPos - kWindowSize) : 0;
+		if ((_pos < windowStart) || ((_pos + count) > _outPos))
+			return false;
+
+		std::memcpy(data, _window + (_pos % kWindowSize), count);
+		return true;
+	}
+
+	/** Inflate until the window holds the data up to this position. */
+	void inflateTo(uint32 end) {
+		// Jump to the last restart point before the data, if that's closer
+		const RestartPoint *point = &_restartPoints.front();
+		for (std::vector<RestartPoint>::const_iterator p = _restartPoints.begin(); p != _restartPoints.end(); ++p)
+			if (p->out <= _pos)
+				point = &*p;
+
+		uint32 windowStart = (_outPos > kWindowSize) ? (_outPos - kWindowSize) : 0;
+		if (!_inflating || (_pos < windowStart) || (point->out > _outPos))
+			restart(*point);
+
+		while (_outPos < end)
+			inflateChunk();
+	}
+
+	/** Inflate up to the end of the current chunk. */
+	void inflateChunk() {
+		uint32 offset = _outPos % kWindowSize;
+
+		_strm.next_out  = _window + offset;
+		_strm.avail_out = MIN(kWindowSize - offset, _size - _outPos);
+
+		while (_strm.avail_out > 0) {
+			if (_strm.avail_in == 0)
+				readInput();
+
+			uint32 availOut = _strm.avail_out;
+
+			int zResult = inflate(&_strm, Z_BLOCK);
+			if ((zResult != Z_OK) && (zResult != Z_STREAM_END))
+				throw Exception("Failed to inflate: %d", zResult);
+
+			_outPos += availOut - _strm.avail_out;
+
+			if ((zResult == Z_STREAM_END) && (_strm.avail_out > 0))
+				throw Exception("Inflated data too short");
+
+			// Remember the decompressor state at the end of a block, every now and then
+			if ((_strm.data_type & 128) && !(_strm.data_type & 64) &&
+			    (_outPos >= (_restartPoints.back().out + kRestartSpan)))
+				addRestartPoint();
+		}
+
+		if (((_outPos % kWindowSize) == 0) || (_outPos == _size))
+			_cache->add(_index, (_outPos - 1) / kWindowSize, _window, ((_outPos - 1) % kWindowSize) + 1);
+
+		// Nothing more to inflate, so free the decompressor
+		if (_outPos == _size)
+			stopInflate();
+	}
+
+	void readInput() {
+		uint32 size = MIN(kInputBufferSize, _compSize - _inPos);
+		if ((size == 0) || (_zip->readAt(_offset + _inPos, _input, size) != size))
+			throw Exception(kReadError);
+
+		_inPos += size;
+
+		_strm.next_in  = _input;
+		_strm.avail_in = size;
+	}
+
+	void addRestartPoint() {
+		_restartPoints.push_back(RestartPoint());
+		RestartPoint &point = _restartPoints.back();
+
+		point.out  = _outPos;
+		point.in   = _inPos - _strm.avail_in;
+		point.bits = _strm.data_type & 7;
+
+		// The window, in order
+		uint32 windowSize = MIN(_outPos, kWindowSize);
+		uint32 start      = (_outPos - windowSize) % kWindowSize;
+		uint32 firstSize  = MIN(windowSize, kWindowSize - start);
+
+		point.window.reset(new byte[windowSize]);
+		std::memcpy(point.window.get(), _window + start, firstSize);
+		std::memcpy(point.window.get() + firstSize, _window, windowSize - firstSize);
+	}
+
+	/** Reset the decompressor to a restart point. */
+	void restart(const RestartPoint &point) {
+		if (!_inflating) {
+			if (inflateInit2(&_strm, -MAX_WBITS) != Z_OK)
+				throw Exception("Could not initialize zlib inflate");
+
+			_input     = new byte[kInputBufferSize];
+			_inflating = true;
+		} else
+			inflateReset(&_strm);
+
+		_strm.next_in  = _input;
+		_strm.avail_in = 0;
+
+		_inPos  = point.in;
+		_outPos = point.out;
+
+		if (point.bits > 0) {
+			// The block starts in the middle of a byte
+			byte prevByte;
+			if (_zip->readAt(_offset + point.in - 1, &prevByte, 1) != 1)
+				throw Exception(kReadError);
+
+			inflatePrime(&_strm, point.bits, prevByte >> (8 - point.bits));
+		}
+
+		if (point.out > 0) {
+			uint32 windowSize = MIN(point.out, kWindowSize);
+			uint32 start      = (point.out - windowSize) % kWindowSize;
+			uint32 firstSize  = MIN(windowSize, kWindowSize - start);
+
+			inflateSetDictionary(&_strm, point.window.get(), windowSize);
+
+			std::memcpy(_window + start, point.window.get(), firstSize);
+			std::memcpy(_window, point.window.get() + firstSize, windowSize - firstSize);
+		}
+	}
+
+	void stopInflate() {
+		if (!_inflating)
+			return;
+
+		inflateEnd(&_strm);
+		delete[] _input;
+
+		_inflating = false;
+	}
+};
+
+
+/** Inflating one file of a ZipFile::getFileBatch() batch. */
+class ZipFile::Inflater : public Job {
+public:
+	SeekableReadStream *stream; ///< The inflated file.
+
+	Inflater(const ZipFile &zip, uint32 index) : stream(0), _zip(&zip), _index(index) {
+	}
+
+	~Inflater() {
+	}
+
+private:
+	const ZipFile *_zip;
+	uint32 _index;
+
+	void run() {
+		stream = _zip->getWholeFile(_index);
+	}
+};
+
+
+ZipFile::ZipFile(const UString &fileName) : _fileName(fileName), _chunkCache(new ZipChunkCache) {
 	load();
 }
 
@@ -51,8 +422,11 @@ void ZipFile::clear() {
 }
 
 void ZipFile::load() {
-	Common::File zip;
-	open(zip);
+	_zip.reset(new Common::File);
+	if (!_zip->open(_fileName))
+		throw Exception(kOpenError);
+
+	Common::File &zip = *_zip;
 
 	uint32 endPos = findCentralDirectoryEnd(zip);
 	if (endPos == 0)
@@ -142,11 +516,15 @@ const ZipFile::IFile &ZipFile::getIFile(uint32 index) const {
 	return _iFiles[index];
 }
 
-void ZipFile::getFileProperties(Common::SeekableReadStream &zip, const IFile &file,
-		uint16 &compMethod, uint32 &compSize, uint32 &realSize) const {
+void ZipFile::getFileProperties(const IFile &file, uint16 &compMethod,
+		uint32 &compSize, uint32 &realSize, uint32 &dataOffset) const {
 
-	if (!zip.seek(file.offset))
-		throw Exception(kSeekError);
+	// Read the local file header
+	byte header[30];
+	if (_zip->readAt(file.offset, header, sizeof(header)) != sizeof(header))
+		throw Exception(kReadError);
+
+	MemoryReadStream zip(header, sizeof(header));
 
 	uint32 tag = zip.readUint32LE();
 	if (tag != 0x04034B50)
@@ -164,66 +542,104 @@ void ZipFile::getFileProperties(Common::SeekableReadStream &zip, const IFile &fi
 	uint16 nameLength  = zip.readUint16LE();
 	uint16 extraLength = zip.readUint16LE();
 
-	zip.skip(nameLength);
-	zip.skip(extraLength);
-
-	if (zip.err())
-		throw Exception(kReadError);
+	dataOffset = file.offset + sizeof(header) + nameLength + extraLength;
 }
 
 uint32 ZipFile::getFileSize(uint32 index) const {
-	const IFile &file = getIFile(index);
+	// The central directory already told us
+	return getIFile(index).size;
+}
 
-	Common::File zip;
-	open(zip);
+SeekableReadStream *ZipFile::getFile(uint32 index) const {
+	const IFile &file = getIFile(index);
 
 	uint16 compMethod;
 	uint32 compSize;
 	uint32 realSize;
+	uint32 dataOffset;
 
-	getFileProperties(zip, file, compMethod, compSize, realSize);
+	getFileProperties(file, compMethod, compSize, realSize, dataOffset);
 
-	return realSize;
+	return decompressFile(index, dataOffset, compMethod, compSize, realSize, true);
 }
 
-SeekableReadStream *ZipFile::getFile(uint32 index) const {
+SeekableReadStream *ZipFile::getWholeFile(uint32 index) const {
 	const IFile &file = getIFile(index);
 
-	Common::File zip;
-	open(zip);
-
 	uint16 compMethod;
 	uint32 compSize;
 	uint32 realSize;
+	uint32 dataOffset;
 
-	getFileProperties(zip, file, compMethod, compSize, realSize);
+	getFileProperties(file, compMethod, compSize, realSize, dataOffset);
 
-	return decompressFile(zip, compMethod, compSize, realSize);
+	return decompressFile(index, dataOffset, compMethod, compSize, realSize, false);
 }
 
-void ZipFile::open(Common::File &file) const {
-	if (!file.open(_fileName))
-		throw Exception(kOpenError);
+void ZipFile::getFileBatch(const std::vector<uint32> &indices, std::vector<SeekableReadStream *> &files) const {
+	if (indices.empty())
+		return;
+
+	std::vector< boost::shared_ptr<Inflater> > jobs;
+	jobs.reserve(indices.size());
+
+	// Inflate the files, on as many threads as is sensible, this one included
+	WorkerPool pool(MIN<uint32>(kInflaterThreadCount, indices.size() - 1));
+	pool.start();
+
+	for (std::vector<uint32>::const_iterator index = indices.begin(); index != indices.end(); ++index) {
+		jobs.push_back(boost::shared_ptr<Inflater>(new Inflater(*this, *index)));
+		pool.add(jobs.back());
+	}
+
+	pool.finish();
+
+	// All or nothing
+	for (std::vector< boost::shared_ptr<Inflater> >::iterator job = jobs.begin(); job != jobs.end(); ++job) {
+		if (!(*job)->hasFailed())
+			continue;
+
+		Exception error = (*job)->getError();
+
+		for (job = jobs.begin(); job != jobs.end(); ++job)
+			delete (*job)->stream;
+
+		throw error;
+	}
+
+	files.reserve(files.size() + jobs.size());
+	for (std::vector< boost::shared_ptr<Inflater> >::iterator job = jobs.begin(); job != jobs.end(); ++job)
+		files.push_back((*job)->stream);
 }
 
-SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32 method,
-		uint32 compSize, uint32 realSize) {
+SeekableReadStream *ZipFile::decompressFile(uint32 index, uint32 offset, uint32 method,
+		uint32 compSize, uint32 realSize, bool lazy) const {
 
 	if (method == 0) {
 		// Uncompressed
 
-		return zip.readStream(compSize);
+		byte *data = new byte[compSize];
+		if (_zip->readAt(offset, data, compSize) != compSize) {
+			delete[] data;
+			throw Exception(kReadError);
+		}
+
+		return new MemoryReadStream(data, compSize, true);
 	}
 
 	if (method != 8)
 		throw Exception("Unhandled Zip compression %d", method);
 
+	// Inflate big files only when they're read
+	if (lazy && (realSize > kMaxWholeInflateSize))
+		return new ZipInflateStream(_zip, _chunkCache, index, offset, compSize, realSize);
+
 	// Allocate the decompressed data
 	byte *decompressedData = new byte[realSize];
 
 	// Read in the compressed data
 	byte *compressedData = new byte[compSize];
-	if (zip.read(compressedData, compSize) != compSize) {
+	if (_zip->readAt(offset, compressedData, compSize) != compSize) {
 		delete[] decompressedData;
 		delete[] compressedData;
 
@@ -249,6 +665,8 @@ SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32 meth
 	strm.next_out = decompressedData;
 
 	zResult = inflate(&strm, Z_SYNC_FLUSH);
+	inflateEnd(&strm);
+
 	if (zResult != Z_OK && zResult != Z_STREAM_END) {
 		delete[] decompressedData;
 		delete[] compressedData;
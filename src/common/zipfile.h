@@ -36,10 +36,13 @@
 #include <list>
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 namespace Common {
 
 class SeekableReadStream;
 class File;
+class ZipChunkCache;
 
 /** A class encapsulating ZIP file access. */
 class ZipFile {
@@ -64,9 +67,20 @@ public:
 	/** Return the size of a file. */
 	uint32 getFileSize(uint32 index) const;
 
-	/** Return a stream of the files's contents. */
+	/** Return a stream of the files's contents.
+	 *
+	 *  Big compressed files are inflated lazily, as the stream is read.
+	 */
 	SeekableReadStream *getFile(uint32 index) const;
 
+	/** Return streams of several files' contents, in the same order.
+	 *
+	 *  The files are inflated completely, concurrently on several threads.
+	 *  If a file can't be read, none of the streams are returned, and the
+	 *  error is thrown.
+	 */
+	void getFileBatch(const std::vector<uint32> &indices, std::vector<SeekableReadStream *> &files) const;
+
 private:
 	/** Internal file information. */
 	struct IFile {
@@ -85,17 +99,25 @@ private:
 	/** The name of the ZIP file. */
 	UString _fileName;
 
-	void open(Common::File &file) const;
+	/** The open ZIP file, shared with the streams of its files. */
+	boost::shared_ptr<Common::File> _zip;
+
+	/** Recently inflated chunks of files, shared with the streams of its files. */
+	boost::shared_ptr<ZipChunkCache> _chunkCache;
 
 	void load();
 	uint32 findCentralDirectoryEnd(SeekableReadStream &zip);
 
-	static SeekableReadStream *decompressFile(SeekableReadStream &zip, uint32 method,
-			uint32 compSize, uint32 realSize);
+	class Inflater;
+
+	SeekableReadStream *getWholeFile(uint32 index) const;
+
+	SeekableReadStream *decompressFile(uint32 index, uint32 offset, uint32 method,
+			uint32 compSize, uint32 realSize, bool lazy) const;
 
 	const IFile &getIFile(uint32 index) const;
-	void getFileProperties(Common::SeekableReadStream &zip, const IFile &file,
-			uint16 &compMethod, uint32 &compSize, uint32 &realSize) const;
+	void getFileProperties(const IFile &file, uint16 &compMethod,
+			uint32 &compSize, uint32 &realSize, uint32 &dataOffset) const;
 };
 
 } // End of namespace Common
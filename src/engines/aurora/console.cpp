@@ -33,6 +33,7 @@
 #include <boost/bind.hpp>
 
 #include "common/util.h"
+#include "common/stream.h"
 #include "common/filepath.h"
 #include "common/readline.h"
 
@@ -668,6 +669,8 @@ Console::Console(const Common::UString &font, int fontHeight) : _neverShown(true
 			"Usage: quitxoreos\nShut down xoreos");
 	registerCommand("dumpreslist", boost::bind(&Console::cmdDumpResList, this, _1),
 			"Usage: dumpreslist <file>\nDump the current list of resources to file");
+	registerCommand("resstats"   , boost::bind(&Console::cmdResStats   , this, _1),
+			"Usage: resstats [reset|<file>]\nPrint resource access statistics, reset them or dump them to file");
 	registerCommand("dumpres"    , boost::bind(&Console::cmdDumpRes    , this, _1),
 			"Usage: dumpres <resource>\nDump a resource to file");
 	registerCommand("dumptga"    , boost::bind(&Console::cmdDumpTGA    , this, _1),
@@ -1080,6 +1083,32 @@ void Console::cmdDumpResList(const CommandLine &cl) {
 		printf("Failed dumping list of resources to file \"%s\"", cl.args.c_str());
 }
 
+void Console::cmdResStats(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		ResMan.resetStats();
+		print("Reset resource access statistics");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		if (dumpResStats(cl.args))
+			printf("Dumped resource access statistics to file \"%s\"", cl.args.c_str());
+		else
+			printf("Failed dumping resource access statistics to file \"%s\"", cl.args.c_str());
+
+		return;
+	}
+
+	Common::MemoryWriteStreamDynamic stats(true);
+	ResMan.writeStats(stats);
+
+	std::vector<Common::UString> lines;
+	Common::UString::split(Common::UString((const char *) stats.getData(), stats.size()), '\n', lines);
+
+	for (std::vector<Common::UString>::const_iterator l = lines.begin(); l != lines.end(); ++l)
+		print(*l);
+}
+
 void Console::cmdDumpRes(const CommandLine &cl) {
 	if (cl.args.empty()) {
 		printCommandHelp(cl.cmd);
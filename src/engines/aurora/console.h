@@ -269,6 +269,7 @@ private:
 	void cmdExit       (const CommandLine &cl);
 	void cmdQuit       (const CommandLine &cl);
 	void cmdDumpResList(const CommandLine &cl);
+	void cmdResStats   (const CommandLine &cl);
 	void cmdDumpRes    (const CommandLine &cl);
 	void cmdDumpTGA    (const CommandLine &cl);
 	void cmdDump2DA    (const CommandLine &cl);
@@ -27,8 +27,11 @@
  *  Generic Aurora engines resource utility functions.
  */
 
+#include "common/util.h"
 #include "common/error.h"
 #include "common/ustring.h"
+#include "common/filepath.h"
+#include "common/configman.h"
 
 #include "events/events.h"
 
@@ -68,6 +71,23 @@ bool indexOptionalArchive(Aurora::ArchiveType archive, const Common::UString &fi
 	return true;
 }
 
+bool batchOptionalArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority) {
+
+	if (!ResMan.hasArchive(archive, file))
+		return false;
+
+	batch.push_back(Aurora::ResourceManager::ArchiveBatchEntry(archive, file, priority));
+	return true;
+}
+
+void indexArchives(Aurora::ResourceManager::ArchiveBatch &batch) {
+	if (EventMan.quitRequested())
+		return;
+
+	ResMan.addArchives(batch);
+}
+
 void indexMandatoryDirectory(const Common::UString &dir,
 		const char *glob, int depth, uint32 priority,
 		Aurora::ResourceManager::ChangeID *change) {
@@ -103,4 +123,32 @@ bool indexOptionalDirectory(const Common::UString &dir,
 }
 
 
+/** Turn a name from the game data into something safe to use as a file name. */
+static Common::UString makeFileName(const Common::UString &name) {
+	Common::UString fileName;
+
+	for (Common::UString::iterator c = name.begin(); c != name.end(); ++c) {
+		if (Common::UString::isAlNum(*c) || (*c == '-') || (*c == '_'))
+			fileName += *c;
+		else
+			fileName += '_';
+	}
+
+	return fileName;
+}
+
+Common::UString getResourceTraceFile(const Common::UString &name) {
+	Common::UString dir = ConfigMan.getString("resourcetrace");
+	if (dir.empty())
+		return "";
+
+	dir = Common::FilePath::makeAbsolute(dir);
+	if (!Common::FilePath::isDirectory(dir)) {
+		warning("Resource trace directory \"%s\" does not exist", dir.c_str());
+		return "";
+	}
+
+	return Common::FilePath::normalize(dir) + "/" + makeFileName(name) + ".trc";
+}
+
 } // End of namespace Engines
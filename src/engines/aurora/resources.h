@@ -46,6 +46,13 @@ void indexMandatoryArchive(Aurora::ArchiveType archive, const Common::UString &f
 bool indexOptionalArchive(Aurora::ArchiveType archive, const Common::UString &file,
 		uint32 priority = 10, Aurora::ResourceManager::ChangeID *change = 0);
 
+/** Add an archive file to a batch, if it exists. */
+bool batchOptionalArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority = 10);
+
+/** Add a batch of archive files to the resource manager, loading them concurrently. */
+void indexArchives(Aurora::ResourceManager::ArchiveBatch &batch);
+
 /** Add a directory to the resource manager, erroring out if it does not exist. */
 void indexMandatoryDirectory(const Common::UString &dir,
 		const char *glob = 0, int depth = -1, uint32 priority = 10,
@@ -56,6 +63,13 @@ bool indexOptionalDirectory(const Common::UString &dir,
 		const char *glob = 0, int depth = -1, uint32 priority = 10,
 		Aurora::ResourceManager::ChangeID *change = 0);
 
+/** Return the file a resource trace of that name is kept in, or "" if resource traces are disabled.
+ *
+ *  The name may come straight from the game data. Everything that's not
+ *  an ASCII letter, digit, '-' or '_' is replaced by '_'.
+ */
+Common::UString getResourceTraceFile(const Common::UString &name);
+
 } // End of namespace Engines
 
 #endif // ENGINES_AURORA_RESOURCES_H
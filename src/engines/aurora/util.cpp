@@ -148,6 +148,18 @@ bool dumpResList(const Common::UString &name) {
 	return false;
 }
 
+bool dumpResStats(const Common::UString &name) {
+	try {
+
+		ResMan.dumpStats(name);
+		return true;
+
+	} catch (...) {
+	}
+
+	return false;
+}
+
 bool dumpStream(Common::SeekableReadStream &stream, const Common::UString &fileName) {
 	Common::DumpFile file;
 	if (!file.open(fileName))
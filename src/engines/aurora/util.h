@@ -64,6 +64,9 @@ bool longDelay(uint32 ms);
 /** Debug method to quickly dump the current list of resource to disk. */
 bool dumpResList(const Common::UString &name);
 
+/** Debug method to quickly dump the resource access statistics to file. */
+bool dumpResStats(const Common::UString &name);
+
 /** Debug method to quickly dump a stream to disk. */
 bool dumpStream(Common::SeekableReadStream &stream, const Common::UString &fileName);
 /** Debug method to quickly dump a resource to disk. */
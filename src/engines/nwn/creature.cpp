@@ -55,6 +55,69 @@
 
 static const uint32 kBICID = MKID_BE('BIC ');
 
+static const Aurora::GFFFieldID kFieldTemplateResRef  ("TemplateResRef");
+static const Aurora::GFFFieldID kFieldXPosition       ("XPosition");
+static const Aurora::GFFFieldID kFieldYPosition       ("YPosition");
+static const Aurora::GFFFieldID kFieldZPosition       ("ZPosition");
+static const Aurora::GFFFieldID kFieldXOrientation    ("XOrientation");
+static const Aurora::GFFFieldID kFieldYOrientation    ("YOrientation");
+static const Aurora::GFFFieldID kFieldTag             ("Tag");
+static const Aurora::GFFFieldID kFieldFirstName       ("FirstName");
+static const Aurora::GFFFieldID kFieldLastName        ("LastName");
+static const Aurora::GFFFieldID kFieldDescription     ("Description");
+static const Aurora::GFFFieldID kFieldConversation    ("Conversation");
+static const Aurora::GFFFieldID kFieldSoundSetFile    ("SoundSetFile");
+static const Aurora::GFFFieldID kFieldGender          ("Gender");
+static const Aurora::GFFFieldID kFieldRace            ("Race");
+static const Aurora::GFFFieldID kFieldSubrace         ("Subrace");
+static const Aurora::GFFFieldID kFieldIsPC            ("IsPC");
+static const Aurora::GFFFieldID kFieldIsDM            ("IsDM");
+static const Aurora::GFFFieldID kFieldAge             ("Age");
+static const Aurora::GFFFieldID kFieldExperience      ("Experience");
+static const Aurora::GFFFieldID kFieldStr             ("Str");
+static const Aurora::GFFFieldID kFieldDex             ("Dex");
+static const Aurora::GFFFieldID kFieldCon             ("Con");
+static const Aurora::GFFFieldID kFieldInt             ("Int");
+static const Aurora::GFFFieldID kFieldWis             ("Wis");
+static const Aurora::GFFFieldID kFieldCha             ("Cha");
+static const Aurora::GFFFieldID kFieldSkillList       ("SkillList");
+static const Aurora::GFFFieldID kFieldRank            ("Rank");
+static const Aurora::GFFFieldID kFieldFeatList        ("FeatList");
+static const Aurora::GFFFieldID kFieldFeat            ("Feat");
+static const Aurora::GFFFieldID kFieldDeity           ("Deity");
+static const Aurora::GFFFieldID kFieldHitPoints       ("HitPoints");
+static const Aurora::GFFFieldID kFieldMaxHitPoints    ("MaxHitPoints");
+static const Aurora::GFFFieldID kFieldCurrentHitPoints("CurrentHitPoints");
+static const Aurora::GFFFieldID kFieldGoodEvil        ("GoodEvil");
+static const Aurora::GFFFieldID kFieldLawfulChaotic   ("LawfulChaotic");
+static const Aurora::GFFFieldID kFieldAppearanceType  ("Appearance_Type");
+static const Aurora::GFFFieldID kFieldPhenotype       ("Phenotype");
+static const Aurora::GFFFieldID kFieldColorSkin       ("Color_Skin");
+static const Aurora::GFFFieldID kFieldColorHair       ("Color_Hair");
+static const Aurora::GFFFieldID kFieldColorTattoo1    ("Color_Tattoo1");
+static const Aurora::GFFFieldID kFieldColorTattoo2    ("Color_Tattoo2");
+static const Aurora::GFFFieldID kFieldPortraitId      ("PortraitId");
+static const Aurora::GFFFieldID kFieldPortrait        ("Portrait");
+static const Aurora::GFFFieldID kFieldEquipItemList   ("Equip_ItemList");
+static const Aurora::GFFFieldID kFieldEquippedRes     ("EquippedRes");
+static const Aurora::GFFFieldID kFieldClassList       ("ClassList");
+static const Aurora::GFFFieldID kFieldClass           ("Class");
+static const Aurora::GFFFieldID kFieldClassLevel      ("ClassLevel");
+
+static const Aurora::TwoDAColumnID kColumnAppearance      ("Appearance");
+static const Aurora::TwoDAColumnID kColumnGender          ("GENDER");
+static const Aurora::TwoDAColumnID kColumnRace            ("RACE");
+static const Aurora::TwoDAColumnID kColumnDefaultPhenoType("DefaultPhenoType");
+static const Aurora::TwoDAColumnID kColumnPortrait        ("PORTRAIT");
+static const Aurora::TwoDAColumnID kColumnModeltype       ("MODELTYPE");
+static const Aurora::TwoDAColumnID kColumnBaseResRef      ("BaseResRef");
+static const Aurora::TwoDAColumnID kColumnConverName      ("ConverName");
+static const Aurora::TwoDAColumnID kColumnConverNameLower ("ConverNameLower");
+static const Aurora::TwoDAColumnID kColumnNamePlural      ("NamePlural");
+static const Aurora::TwoDAColumnID kColumnName            ("Name");
+static const Aurora::TwoDAColumnID kColumnLower           ("Lower");
+static const Aurora::TwoDAColumnID kColumnPlural          ("Plural");
+
 namespace Engines {
 
 namespace NWN {
@@ -360,13 +423,13 @@ void Creature::getPartModels() {
 
 	const Aurora::TwoDARow &gender = TwoDAReg.get("gender").getRow(_gender);
 	const Aurora::TwoDARow &race   = TwoDAReg.get("racialtypes").getRow(_race);
-	const Aurora::TwoDARow &raceAp = appearance.getRow(race.getInt("Appearance"));
+	const Aurora::TwoDARow &raceAp = appearance.getRow(race.getInt(kColumnAppearance));
 	const Aurora::TwoDARow &pheno  = TwoDAReg.get("phenotype").getRow(_phenotype);
 
-	Common::UString genderChar   = gender.getString("GENDER");
-	Common::UString raceChar     = raceAp.getString("RACE");
+	Common::UString genderChar   = gender.getString(kColumnGender);
+	Common::UString raceChar     = raceAp.getString(kColumnRace);
 	Common::UString phenoChar    = Common::UString::sprintf("%d", _phenotype);
-	Common::UString phenoAltChar = pheno.getString("DefaultPhenoType");
+	Common::UString phenoAltChar = pheno.getString(kColumnDefaultPhenoType);
 
 	// Important to capture the supermodel
 	_partsSuperModelName = Common::UString::sprintf("p%s%s%s",
@@ -440,9 +503,9 @@ void Creature::loadModel() {
 	const Aurora::TwoDARow &appearance = TwoDAReg.get("appearance").getRow(_appearanceID);
 
 	if (_portrait.empty())
-		_portrait = appearance.getString("PORTRAIT");
+		_portrait = appearance.getString(kColumnPortrait);
 
-	if (appearance.getString("MODELTYPE") == "P") {
+	if (appearance.getString(kColumnModeltype) == "P") {
 		getArmorModels();
 		getPartModels();
 		_model = loadModelObject(_partsSuperModelName);
@@ -469,7 +532,7 @@ void Creature::loadModel() {
 		}
 
 	} else
-		_model = loadModelObject(appearance.getString("RACE"));
+		_model = loadModelObject(appearance.getString(kColumnRace));
 
 	// Positioning
 
@@ -520,7 +583,7 @@ void Creature::loadCharacter(const Common::UString &bic, bool local) {
 }
 
 void Creature::load(const Aurora::GFFStruct &creature) {
-	Common::UString temp = creature.getString("TemplateResRef");
+	Common::UString temp = creature.getString(kFieldTemplateResRef);
 
 	Aurora::GFFFile *utc = 0;
 	if (!temp.empty()) {
@@ -547,14 +610,14 @@ void Creature::load(const Aurora::GFFStruct &instance, const Aurora::GFFStruct *
 
 	// Position
 
-	setPosition(instance.getDouble("XPosition"),
-	            instance.getDouble("YPosition"),
-	            instance.getDouble("ZPosition"));
+	setPosition(instance.getDouble(kFieldXPosition),
+	            instance.getDouble(kFieldYPosition),
+	            instance.getDouble(kFieldZPosition));
 
 	// Orientation
 
-	float bearingX = instance.getDouble("XOrientation");
-	float bearingY = instance.getDouble("YOrientation");
+	float bearingX = instance.getDouble(kFieldXOrientation);
+	float bearingY = instance.getDouble(kFieldYOrientation);
 
 	float o[3];
 	Common::vector2orientation(bearingX, bearingY, o[0], o[1], o[2]);
@@ -562,38 +625,45 @@ void Creature::load(const Aurora::GFFStruct &instance, const Aurora::GFFStruct *
 	setOrientation(o[0], o[1], o[2]);
 }
 
-static const char *kBodyPartFields[] = {
-	"Appearance_Head",
-	"BodyPart_Neck"  ,
-	"BodyPart_Torso" ,
-	"BodyPart_Pelvis",
-	"BodyPart_Belt"  ,
-	"ArmorPart_RFoot", "BodyPart_LFoot" ,
-	"BodyPart_RShin" , "BodyPart_LShin" ,
-	"BodyPart_LThigh", "BodyPart_RThigh",
-	"BodyPart_RFArm" , "BodyPart_LFArm" ,
-	"BodyPart_RBicep", "BodyPart_LBicep",
-	"BodyPart_RShoul", "BodyPart_LShoul",
-	"BodyPart_RHand" , "BodyPart_LHand"
+static const Aurora::GFFFieldID kBodyPartFields[] = {
+	Aurora::GFFFieldID("Appearance_Head"),
+	Aurora::GFFFieldID("BodyPart_Neck"),
+	Aurora::GFFFieldID("BodyPart_Torso"),
+	Aurora::GFFFieldID("BodyPart_Pelvis"),
+	Aurora::GFFFieldID("BodyPart_Belt"),
+	Aurora::GFFFieldID("ArmorPart_RFoot"),
+	Aurora::GFFFieldID("BodyPart_LFoot"),
+	Aurora::GFFFieldID("BodyPart_RShin"),
+	Aurora::GFFFieldID("BodyPart_LShin"),
+	Aurora::GFFFieldID("BodyPart_LThigh"),
+	Aurora::GFFFieldID("BodyPart_RThigh"),
+	Aurora::GFFFieldID("BodyPart_RFArm"),
+	Aurora::GFFFieldID("BodyPart_LFArm"),
+	Aurora::GFFFieldID("BodyPart_RBicep"),
+	Aurora::GFFFieldID("BodyPart_LBicep"),
+	Aurora::GFFFieldID("BodyPart_RShoul"),
+	Aurora::GFFFieldID("BodyPart_LShoul"),
+	Aurora::GFFFieldID("BodyPart_RHand"),
+	Aurora::GFFFieldID("BodyPart_LHand")
 };
 
 void Creature::loadProperties(const Aurora::GFFStruct &gff) {
 	// Tag
 
-	_tag = gff.getString("Tag", _tag);
+	_tag = gff.getString(kFieldTag, _tag);
 
 	// Name
 
-	if (gff.hasField("FirstName")) {
+	if (gff.hasField(kFieldFirstName)) {
 		Aurora::LocString firstName;
-		gff.getLocString("FirstName", firstName);
+		gff.getLocString(kFieldFirstName, firstName);
 
 		_firstName = firstName.getString();
 	}
 
-	if (gff.hasField("LastName")) {
+	if (gff.hasField(kFieldLastName)) {
 		Aurora::LocString lastName;
-		gff.getLocString("LastName", lastName);
+		gff.getLocString(kFieldLastName, lastName);
 
 		_lastName = lastName.getString();
 	}
@@ -603,98 +673,98 @@ void Creature::loadProperties(const Aurora::GFFStruct &gff) {
 
 	// Description
 
-	if (gff.hasField("Description")) {
+	if (gff.hasField(kFieldDescription)) {
 		Aurora::LocString description;
-		gff.getLocString("Description", description);
+		gff.getLocString(kFieldDescription, description);
 
 		_description = description.getString();
 	}
 
 	// Conversation
 
-	_conversation = gff.getString("Conversation", _conversation);
+	_conversation = gff.getString(kFieldConversation, _conversation);
 
 	// Sound Set
 
-	_soundSet = gff.getUint("SoundSetFile", Aurora::kFieldIDInvalid);
+	_soundSet = gff.getUint(kFieldSoundSetFile, Aurora::kFieldIDInvalid);
 
 	// Portrait
 
 	loadPortrait(gff, _portrait);
 
 	// Gender
-	_gender = gff.getUint("Gender", _gender);
+	_gender = gff.getUint(kFieldGender, _gender);
 
 	// Race
-	_race = gff.getUint("Race", _race);
+	_race = gff.getUint(kFieldRace, _race);
 
 	// Subrace
-	_subRace = gff.getString("Subrace", _subRace);
+	_subRace = gff.getString(kFieldSubrace, _subRace);
 
 	// PC and DM
-	_isPC = gff.getBool("IsPC", _isPC);
-	_isDM = gff.getBool("IsDM", _isDM);
+	_isPC = gff.getBool(kFieldIsPC, _isPC);
+	_isDM = gff.getBool(kFieldIsDM, _isDM);
 
 	// Age
-	_age = gff.getUint("Age", _age);
+	_age = gff.getUint(kFieldAge, _age);
 
 	// Experience
-	_xp = gff.getUint("Experience", _xp);
+	_xp = gff.getUint(kFieldExperience, _xp);
 
 	// Abilities
-	_abilities[kAbilityStrength]     = gff.getUint("Str", _abilities[kAbilityStrength]);
-	_abilities[kAbilityDexterity]    = gff.getUint("Dex", _abilities[kAbilityDexterity]);
-	_abilities[kAbilityConstitution] = gff.getUint("Con", _abilities[kAbilityConstitution]);
-	_abilities[kAbilityIntelligence] = gff.getUint("Int", _abilities[kAbilityIntelligence]);
-	_abilities[kAbilityWisdom]       = gff.getUint("Wis", _abilities[kAbilityWisdom]);
-	_abilities[kAbilityCharisma]     = gff.getUint("Cha", _abilities[kAbilityCharisma]);
+	_abilities[kAbilityStrength]     = gff.getUint(kFieldStr, _abilities[kAbilityStrength]);
+	_abilities[kAbilityDexterity]    = gff.getUint(kFieldDex, _abilities[kAbilityDexterity]);
+	_abilities[kAbilityConstitution] = gff.getUint(kFieldCon, _abilities[kAbilityConstitution]);
+	_abilities[kAbilityIntelligence] = gff.getUint(kFieldInt, _abilities[kAbilityIntelligence]);
+	_abilities[kAbilityWisdom]       = gff.getUint(kFieldWis, _abilities[kAbilityWisdom]);
+	_abilities[kAbilityCharisma]     = gff.getUint(kFieldCha, _abilities[kAbilityCharisma]);
 
 	// Classes
 	loadClasses(gff, _classes, _hitDice);
 
 	// Skills
-	if (gff.hasField("SkillList")) {
+	if (gff.hasField(kFieldSkillList)) {
 		_skills.clear();
 
-		const Aurora::GFFList &skills = gff.getList("SkillList");
+		const Aurora::GFFList &skills = gff.getList(kFieldSkillList);
 		for (Aurora::GFFList::const_iterator s = skills.begin(); s != skills.end(); ++s) {
 			const Aurora::GFFStruct &skill = **s;
 
-			_skills.push_back(skill.getSint("Rank"));
+			_skills.push_back(skill.getSint(kFieldRank));
 		}
 	}
 
 	// Feats
-	if (gff.hasField("FeatList")) {
+	if (gff.hasField(kFieldFeatList)) {
 		_feats.clear();
 
-		const Aurora::GFFList &feats = gff.getList("FeatList");
+		const Aurora::GFFList &feats = gff.getList(kFieldFeatList);
 		for (Aurora::GFFList::const_iterator f = feats.begin(); f != feats.end(); ++f) {
 			const Aurora::GFFStruct &feat = **f;
 
-			_feats.push_back(feat.getUint("Feat"));
+			_feats.push_back(feat.getUint(kFieldFeat));
 		}
 	}
 
 	// Deity
-	_deity = gff.getString("Deity", _deity);
+	_deity = gff.getString(kFieldDeity, _deity);
 
 	// Health
-	if (gff.hasField("HitPoints")) {
-		_baseHP    = gff.getSint("HitPoints");
-		_bonusHP   = gff.getSint("MaxHitPoints", _baseHP) - _baseHP;
-		_currentHP = gff.getSint("CurrentHitPoints", _baseHP);
+	if (gff.hasField(kFieldHitPoints)) {
+		_baseHP    = gff.getSint(kFieldHitPoints);
+		_bonusHP   = gff.getSint(kFieldMaxHitPoints, _baseHP) - _baseHP;
+		_currentHP = gff.getSint(kFieldCurrentHitPoints, _baseHP);
 	}
 
 	// Alignment
 
-	_goodEvil = gff.getUint("GoodEvil", _goodEvil);
-	_lawChaos = gff.getUint("LawfulChaotic", _lawChaos);
+	_goodEvil = gff.getUint(kFieldGoodEvil, _goodEvil);
+	_lawChaos = gff.getUint(kFieldLawfulChaotic, _lawChaos);
 
 	// Appearance
 
-	_appearanceID = gff.getUint("Appearance_Type", _appearanceID);
-	_phenotype    = gff.getUint("Phenotype"      , _phenotype);
+	_appearanceID = gff.getUint(kFieldAppearanceType, _appearanceID);
+	_phenotype    = gff.getUint(kFieldPhenotype      , _phenotype);
 
 	// Body parts
 	for (uint i = 0; i < kBodyPartMAX; i++) {
@@ -703,10 +773,10 @@ void Creature::loadProperties(const Aurora::GFFStruct &gff) {
 	}
 
 	// Colors
-	_colorSkin    = gff.getUint("Color_Skin", _colorSkin);
-	_colorHair    = gff.getUint("Color_Hair", _colorHair);
-	_colorTattoo1 = gff.getUint("Color_Tattoo1", _colorTattoo1);
-	_colorTattoo2 = gff.getUint("Color_Tattoo2", _colorTattoo2);
+	_colorSkin    = gff.getUint(kFieldColorSkin, _colorSkin);
+	_colorHair    = gff.getUint(kFieldColorHair, _colorHair);
+	_colorTattoo1 = gff.getUint(kFieldColorTattoo1, _colorTattoo1);
+	_colorTattoo2 = gff.getUint(kFieldColorTattoo2, _colorTattoo2);
 
 	// Equipped Items
 	loadEquippedItems(gff);
@@ -716,29 +786,29 @@ void Creature::loadProperties(const Aurora::GFFStruct &gff) {
 }
 
 void Creature::loadPortrait(const Aurora::GFFStruct &gff, Common::UString &portrait) {
-	uint32 portraitID = gff.getUint("PortraitId");
+	uint32 portraitID = gff.getUint(kFieldPortraitId);
 	if (portraitID != 0) {
 		const Aurora::TwoDAFile &twoda = TwoDAReg.get("portraits");
 
-		Common::UString portrait2DA = twoda.getRow(portraitID).getString("BaseResRef");
+		Common::UString portrait2DA = twoda.getRow(portraitID).getString(kColumnBaseResRef);
 		if (!portrait2DA.empty())
 			portrait = "po_" + portrait2DA;
 	}
 
-	portrait = gff.getString("Portrait", portrait);
+	portrait = gff.getString(kFieldPortrait, portrait);
 }
 
 void Creature::loadEquippedItems(const Aurora::GFFStruct &gff) {
-	if (!gff.hasField("Equip_ItemList"))
+	if (!gff.hasField(kFieldEquipItemList))
 		return;
 
-	const Aurora::GFFList &cEquipped = gff.getList("Equip_ItemList");
+	const Aurora::GFFList &cEquipped = gff.getList(kFieldEquipItemList);
 	for (Aurora::GFFList::const_iterator e = cEquipped.begin(); e != cEquipped.end(); ++e) {
 		const Aurora::GFFStruct &cItem = **e;
 
-		Common::UString itemref = cItem.getString("EquippedRes");
+		Common::UString itemref = cItem.getString(kFieldEquippedRes);
 		if (itemref.empty())
-			itemref = cItem.getString("TemplateResRef");
+			itemref = cItem.getString(kFieldTemplateResRef);
 
 		Aurora::GFFFile *uti = 0;
 		if (!itemref.empty()) {
@@ -764,39 +834,39 @@ void Creature::loadEquippedItems(const Aurora::GFFStruct &gff) {
 void Creature::loadClasses(const Aurora::GFFStruct &gff,
                            std::vector<Class> &classes, uint8 &hitDice) {
 
-	if (!gff.hasField("ClassList"))
+	if (!gff.hasField(kFieldClassList))
 		return;
 
 	classes.clear();
 	hitDice = 0;
 
-	const Aurora::GFFList &cClasses = gff.getList("ClassList");
+	const Aurora::GFFList &cClasses = gff.getList(kFieldClassList);
 	for (Aurora::GFFList::const_iterator c = cClasses.begin(); c != cClasses.end(); ++c) {
 		classes.push_back(Class());
 
 		const Aurora::GFFStruct &cClass = **c;
 
-		classes.back().classID = cClass.getUint("Class");
-		classes.back().level   = cClass.getUint("ClassLevel");
+		classes.back().classID = cClass.getUint(kFieldClass);
+		classes.back().level   = cClass.getUint(kFieldClassLevel);
 
 		hitDice += classes.back().level;
 	}
 }
 
 const Common::UString &Creature::getConvRace() const {
-	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt("ConverName");
+	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt(kColumnConverName);
 
 	return TalkMan.getString(strRef);
 }
 
 const Common::UString &Creature::getConvrace() const {
-	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt("ConverNameLower");
+	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt(kColumnConverNameLower);
 
 	return TalkMan.getString(strRef);
 }
 
 const Common::UString &Creature::getConvRaces() const {
-	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt("NamePlural");
+	const uint32 strRef = TwoDAReg.get("racialtypes").getRow(_race).getInt(kColumnNamePlural);
 
 	return TalkMan.getString(strRef);
 }
@@ -826,21 +896,21 @@ uint16 Creature::getClassLevel(uint32 classID) const {
 
 const Common::UString &Creature::getConvClass() const {
 	const uint32 classID = _classes.front().classID;
-	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt("Name");
+	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt(kColumnName);
 
 	return TalkMan.getString(strRef);
 }
 
 const Common::UString &Creature::getConvclass() const {
 	const uint32 classID = _classes.front().classID;
-	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt("Lower");
+	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt(kColumnLower);
 
 	return TalkMan.getString(strRef);
 }
 
 const Common::UString &Creature::getConvClasses() const {
 	const uint32 classID = _classes.front().classID;
-	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt("Plural");
+	const uint32 strRef  = TwoDAReg.get("classes").getRow(classID).getInt(kColumnPlural);
 
 	return TalkMan.getString(strRef);
 }
@@ -1029,7 +1099,7 @@ void Creature::getClassString(const std::vector<Class> &classes, Common::UString
 		if (!str.empty())
 			str += '/';
 
-		uint32 strRef = TwoDAReg.get("classes").getRow(c->classID).getInt("Name");
+		uint32 strRef = TwoDAReg.get("classes").getRow(c->classID).getInt(kColumnName);
 
 		str += TalkMan.getString(strRef);
 	}
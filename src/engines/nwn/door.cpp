@@ -43,6 +43,15 @@
 #include "engines/nwn/waypoint.h"
 #include "engines/nwn/module.h"
 
+static const Aurora::GFFFieldID kFieldTemplateResRef("TemplateResRef");
+static const Aurora::GFFFieldID kFieldGenericType   ("GenericType");
+static const Aurora::GFFFieldID kFieldAnimationState("AnimationState");
+static const Aurora::GFFFieldID kFieldLinkedToFlags ("LinkedToFlags");
+static const Aurora::GFFFieldID kFieldLinkedTo      ("LinkedTo");
+
+static const Aurora::TwoDAColumnID kColumnVisibleModel("VisibleModel");
+static const Aurora::TwoDAColumnID kColumnSoundAppType("SoundAppType");
+
 namespace Engines {
 
 namespace NWN {
@@ -59,7 +68,7 @@ Door::~Door() {
 }
 
 void Door::load(const Aurora::GFFStruct &door) {
-	Common::UString temp = door.getString("TemplateResRef");
+	Common::UString temp = door.getString(kFieldTemplateResRef);
 
 	Aurora::GFFFile *utd = 0;
 	if (!temp.empty()) {
@@ -80,16 +89,16 @@ void Door::load(const Aurora::GFFStruct &door) {
 void Door::loadObject(const Aurora::GFFStruct &gff) {
 	// Generic type
 
-	_genericType = gff.getUint("GenericType", _genericType);
+	_genericType = gff.getUint(kFieldGenericType, _genericType);
 
 	// State
 
-	_state = (State) gff.getUint("AnimationState", (uint) _state);
+	_state = (State) gff.getUint(kFieldAnimationState, (uint) _state);
 
 	// Linked to
 
-	_linkedToFlag = (LinkedToFlag) gff.getUint("LinkedToFlags", (uint) _linkedToFlag);
-	_linkedTo     = gff.getString("LinkedTo");
+	_linkedToFlag = (LinkedToFlag) gff.getUint(kFieldLinkedToFlags, (uint) _linkedToFlag);
+	_linkedTo     = gff.getString(kFieldLinkedTo);
 }
 
 void Door::loadAppearance() {
@@ -113,9 +122,9 @@ void Door::loadAppearance(const Aurora::TwoDAFile &twoda, uint32 id) {
 	if (modelColumn == Aurora::kFieldIDInvalid)
 		modelColumn = twoda.headerToColumn("Model");
 
-	_invisible    = twoda.getRow(id).getInt("VisibleModel") == 0;
+	_invisible    = twoda.getRow(id).getInt(kColumnVisibleModel) == 0;
 	_modelName    = twoda.getRow(id).getString(modelColumn);
-	_soundAppType = twoda.getRow(id).getInt("SoundAppType");
+	_soundAppType = twoda.getRow(id).getInt(kColumnSoundAppType);
 }
 
 void Door::setModelState() {
@@ -699,10 +699,31 @@ void Dialog::updateBox() {
 
 	_dlgBox->clear();
 
-	// Entry
+	const Aurora::DLGFile::Line *entry = _dlg->getCurrentEntry();
+	const std::vector<const Aurora::DLGFile::Line *> &replies = _dlg->getCurrentReplies();
 
+	// Decode all strings of this step together, in one pass over the talk table
+
+	std::vector<uint32> strRefs;
+
+	strRefs.push_back(kContinue);
+	strRefs.push_back(kEndDialog);
+
+	if (entry)
+		strRefs.push_back(entry->text.getID());
+
+	for (std::vector<const Aurora::DLGFile::Line *>::const_iterator r = replies.begin();
+	     r != replies.end(); ++r)
+		strRefs.push_back((*r)->text.getID());
+
+	std::vector<Common::UString> strings;
+	TalkMan.getStrings(strRefs, strings);
+
+	const Common::UString &continueText = strings[0];
+	const Common::UString &endText      = strings[1];
+
+	// Entry
 
-	const Aurora::DLGFile::Line *entry = _dlg->getCurrentEntry();
 	if (entry) {
 		// Name and portrait
 
@@ -720,19 +741,18 @@ void Dialog::updateBox() {
 
 	// Replies
 
-	const std::vector<const Aurora::DLGFile::Line *> &replies = _dlg->getCurrentReplies();
 	if (!replies.empty()) {
 		for (std::vector<const Aurora::DLGFile::Line *>::const_iterator r = replies.begin();
 				 r != replies.end(); ++r) {
 
 			Common::UString text = (*r)->text.getString();
 			if (text.empty())
-				text = TalkMan.getString((*r)->isEnd ? kEndDialog : kContinue);
+				text = (*r)->isEnd ? endText : continueText;
 
 			_dlgBox->addReply(text, (*r)->id);
 		}
 	} else
-		_dlgBox->addReply(TalkMan.getString(kEndDialog), Aurora::DLGFile::kEndLine);
+		_dlgBox->addReply(endText, Aurora::DLGFile::kEndLine);
 
 	_dlgBox->finishReplies();
 
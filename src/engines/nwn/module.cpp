@@ -147,6 +147,9 @@ bool Module::loadModule(const Common::UString &module) {
 
 	_newModule.clear();
 
+	if (ConfigMan.getBool("talkwarmup", true))
+		warmUpTalkTable();
+
 	_hasModule = true;
 	return true;
 }
@@ -173,6 +176,19 @@ void Module::checkHAKs() {
 			throw Common::Exception("Required hak \"%s\" does not exist", h->c_str());
 }
 
+void Module::warmUpTalkTable() {
+	std::vector<Aurora::FileType> types;
+
+	types.push_back(Aurora::kFileTypeDLG);
+	types.push_back(Aurora::kFileTypeUTC);
+	types.push_back(Aurora::kFileTypeUTI);
+
+	std::list<Aurora::ResourceManager::ResourceID> gffs;
+	ResMan.getAvailableResources(_resModule, types, gffs);
+
+	TalkMan.warmUp(gffs);
+}
+
 void Module::setPCTokens() {
 	TokenMan.set("<FullName>" , _pc->getName());
 	TokenMan.set("<FirstName>", _pc->getFirstName());
@@ -357,8 +373,24 @@ void Module::enterArea() {
 
 	_currentArea = area->second;
 
+	// Read ahead what the area needed last time, and record what it needs now
+	Common::UString traceFile = getResourceTraceFile(_tag + "-" + _currentArea->getResRef());
+	if (!traceFile.empty()) {
+		ResMan.replayTrace(traceFile);
+		ResMan.startTrace();
+	}
+
 	_currentArea->show();
 
+	if (!traceFile.empty()) {
+		try {
+			ResMan.stopTrace(traceFile);
+		} catch (Common::Exception &e) {
+			e.add("Failed writing resource trace \"%s\"", traceFile.c_str());
+			Common::printException(e, "WARNING: ");
+		}
+	}
+
 	EventMan.flushEvents();
 
 	_ingameGUI->setArea(_currentArea->getName());
@@ -532,6 +564,9 @@ void Module::unloadModule() {
 
 	_ifo.unload();
 
+	// The warm-up might still be reading out of the module
+	TalkMan.cancelWarmUp();
+
 	ResMan.undo(_resModule);
 
 	_newModule.clear();
@@ -167,6 +167,9 @@ private:
 	void checkXPs();  ///< Do we have all expansions needed for the module?
 	void checkHAKs(); ///< Do we have all HAKs needed for the module?
 
+	/** Decode the strings used by the module's dialogs, creatures and items in the background. */
+	void warmUpTalkTable();
+
 	void loadHAKs();        ///< Load the HAKs required by the module.
 	void loadTexturePack(); ///< Load the texture pack.
 	void loadAreas();       ///< Load the areas.
@@ -183,30 +183,33 @@ void NWNEngine::initResources() {
 	ResMan.addArchiveDir(Aurora::kArchiveERF, "hak");
 	ResMan.addArchiveDir(Aurora::kArchiveERF, "texturepacks");
 
-	status("Loading main KEY");
-	indexMandatoryArchive(Aurora::kArchiveKEY, "chitin.key", 1);
+	status("Loading main KEY, expansions and patch KEYs and GUI textures");
 
-	status("Loading expansions and patch KEYs");
+	Aurora::ResourceManager::ArchiveBatch archives;
+
+	archives.push_back(Aurora::ResourceManager::ArchiveBatchEntry(Aurora::kArchiveKEY, "chitin.key", 1));
 
 	// Base game patch
-	indexOptionalArchive(Aurora::kArchiveKEY, "patch.key", 2);
+	batchOptionalArchive(archives, Aurora::kArchiveKEY, "patch.key", 2);
 
 	// Expansion 1: Shadows of Undrentide (SoU)
-	_hasXP1 = indexOptionalArchive(Aurora::kArchiveKEY, "xp1.key", 3);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp1patch.key", 4);
+	_hasXP1 = batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp1.key", 3);
+	batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp1patch.key", 4);
 
 	// Expansion 2: Hordes of the Underdark (HotU)
-	_hasXP2 = indexOptionalArchive(Aurora::kArchiveKEY, "xp2.key", 5);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp2patch.key", 6);
+	_hasXP2 = batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp2.key", 5);
+	batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp2patch.key", 6);
 
 	// Expansion 3: Kingmaker (resources also included in the final 1.69 patch)
-	_hasXP3 = indexOptionalArchive(Aurora::kArchiveKEY, "xp3.key", 7);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp3patch.key", 8);
+	_hasXP3 = batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp3.key", 7);
+	batchOptionalArchive(archives, Aurora::kArchiveKEY, "xp3patch.key", 8);
+
+	// GUI textures
+	archives.push_back(Aurora::ResourceManager::ArchiveBatchEntry(Aurora::kArchiveERF, "gui_32bit.erf", 10));
+	batchOptionalArchive(archives, Aurora::kArchiveERF, "xp1_gui.erf", 11);
+	batchOptionalArchive(archives, Aurora::kArchiveERF, "xp2_gui.erf", 12);
 
-	status("Loading GUI textures");
-	indexMandatoryArchive(Aurora::kArchiveERF, "gui_32bit.erf"   , 10);
-	indexOptionalArchive (Aurora::kArchiveERF, "xp1_gui.erf"     , 11);
-	indexOptionalArchive (Aurora::kArchiveERF, "xp2_gui.erf"     , 12);
+	indexArchives(archives);
 
 	status("Indexing extra sound resources");
 	indexMandatoryDirectory("ambient"   , 0, 0, 20);
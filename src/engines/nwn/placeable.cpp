@@ -41,6 +41,12 @@
 
 #include "engines/nwn/gui/widgets/tooltip.h"
 
+static const Aurora::GFFFieldID kFieldTemplateResRef("TemplateResRef");
+static const Aurora::GFFFieldID kFieldAnimationState("AnimationState");
+
+static const Aurora::TwoDAColumnID kColumnModelName   ("ModelName");
+static const Aurora::TwoDAColumnID kColumnSoundAppType("SoundAppType");
+
 namespace Engines {
 
 namespace NWN {
@@ -56,7 +62,7 @@ Placeable::~Placeable() {
 }
 
 void Placeable::load(const Aurora::GFFStruct &placeable) {
-	Common::UString temp = placeable.getString("TemplateResRef");
+	Common::UString temp = placeable.getString(kFieldTemplateResRef);
 
 	Aurora::GFFFile *utp = 0;
 	if (!temp.empty()) {
@@ -122,14 +128,14 @@ void Placeable::hide() {
 void Placeable::loadObject(const Aurora::GFFStruct &gff) {
 	// State
 
-	_state = (State) gff.getUint("AnimationState", (uint) _state);
+	_state = (State) gff.getUint(kFieldAnimationState, (uint) _state);
 }
 
 void Placeable::loadAppearance() {
 	const Aurora::TwoDAFile &twoda = TwoDAReg.get("placeables");
 
-	_modelName    = twoda.getRow(_appearanceID).getString("ModelName");
-	_soundAppType = twoda.getRow(_appearanceID).getInt("SoundAppType");
+	_modelName    = twoda.getRow(_appearanceID).getString(kColumnModelName);
+	_soundAppType = twoda.getRow(_appearanceID).getInt(kColumnSoundAppType);
 }
 
 void Placeable::enter() {
@@ -43,6 +43,28 @@
 
 #include "engines/nwn/situated.h"
 
+static const Aurora::GFFFieldID kFieldX           ("X");
+static const Aurora::GFFFieldID kFieldY           ("Y");
+static const Aurora::GFFFieldID kFieldZ           ("Z");
+static const Aurora::GFFFieldID kFieldBearing     ("Bearing");
+static const Aurora::GFFFieldID kFieldTag         ("Tag");
+static const Aurora::GFFFieldID kFieldLocName     ("LocName");
+static const Aurora::GFFFieldID kFieldDescription ("Description");
+static const Aurora::GFFFieldID kFieldAppearance  ("Appearance");
+static const Aurora::GFFFieldID kFieldConversation("Conversation");
+static const Aurora::GFFFieldID kFieldStatic      ("Static");
+static const Aurora::GFFFieldID kFieldUseable     ("Useable");
+static const Aurora::GFFFieldID kFieldLocked      ("Locked");
+static const Aurora::GFFFieldID kFieldPortraitId  ("PortraitId");
+static const Aurora::GFFFieldID kFieldPortrait    ("Portrait");
+
+static const Aurora::TwoDAColumnID kColumnBaseResRef("BaseResRef");
+static const Aurora::TwoDAColumnID kColumnOpened    ("Opened");
+static const Aurora::TwoDAColumnID kColumnClosed    ("Closed");
+static const Aurora::TwoDAColumnID kColumnDestroyed ("Destroyed");
+static const Aurora::TwoDAColumnID kColumnUsed      ("Used");
+static const Aurora::TwoDAColumnID kColumnLocked    ("Locked");
+
 namespace Engines {
 
 namespace NWN {
@@ -155,33 +177,33 @@ void Situated::load(const Aurora::GFFStruct &instance, const Aurora::GFFStruct *
 
 	// Position
 
-	setPosition(instance.getDouble("X"),
-	            instance.getDouble("Y"),
-	            instance.getDouble("Z"));
+	setPosition(instance.getDouble(kFieldX),
+	            instance.getDouble(kFieldY),
+	            instance.getDouble(kFieldZ));
 
 	// Orientation
 
-	float bearing = instance.getDouble("Bearing");
+	float bearing = instance.getDouble(kFieldBearing);
 
 	setOrientation(0.0, Common::rad2deg(bearing), 0.0);
 }
 
 void Situated::loadProperties(const Aurora::GFFStruct &gff) {
 	// Tag
-	_tag = gff.getString("Tag", _tag);
+	_tag = gff.getString(kFieldTag, _tag);
 
 	// Name
-	if (gff.hasField("LocName")) {
+	if (gff.hasField(kFieldLocName)) {
 		Aurora::LocString name;
-		gff.getLocString("LocName", name);
+		gff.getLocString(kFieldLocName, name);
 
 		_name = name.getString();
 	}
 
 	// Description
-	if (gff.hasField("Description")) {
+	if (gff.hasField(kFieldDescription)) {
 		Aurora::LocString description;
-		gff.getLocString("Description", description);
+		gff.getLocString(kFieldDescription, description);
 
 		_description = description.getString();
 	}
@@ -190,35 +212,35 @@ void Situated::loadProperties(const Aurora::GFFStruct &gff) {
 	loadPortrait(gff);
 
 	// Appearance
-	_appearanceID = gff.getUint("Appearance", _appearanceID);
+	_appearanceID = gff.getUint(kFieldAppearance, _appearanceID);
 
 	// Conversation
-	_conversation = gff.getString("Conversation", _conversation);
+	_conversation = gff.getString(kFieldConversation, _conversation);
 
 	// Static
-	_static = gff.getBool("Static", _static);
+	_static = gff.getBool(kFieldStatic, _static);
 
 	// Usable
-	_usable = gff.getBool("Useable", _usable);
+	_usable = gff.getBool(kFieldUseable, _usable);
 
 	// Locked
-	_locked = gff.getBool("Locked", _locked);
+	_locked = gff.getBool(kFieldLocked, _locked);
 
 	// Scripts
 	readScripts(gff);
 }
 
 void Situated::loadPortrait(const Aurora::GFFStruct &gff) {
-	uint32 portraitID = gff.getUint("PortraitId");
+	uint32 portraitID = gff.getUint(kFieldPortraitId);
 	if (portraitID != 0) {
 		const Aurora::TwoDAFile &twoda = TwoDAReg.get("portraits");
 
-		Common::UString portrait = twoda.getRow(portraitID).getString("BaseResRef");
+		Common::UString portrait = twoda.getRow(portraitID).getString(kColumnBaseResRef);
 		if (!portrait.empty())
 			_portrait = "po_" + portrait;
 	}
 
-	_portrait = gff.getString("Portrait", _portrait);
+	_portrait = gff.getString(kFieldPortrait, _portrait);
 }
 
 void Situated::loadSounds() {
@@ -227,11 +249,11 @@ void Situated::loadSounds() {
 
 	const Aurora::TwoDAFile &twoda = TwoDAReg.get("placeableobjsnds");
 
-	_soundOpened    = twoda.getRow(_soundAppType).getString("Opened");
-	_soundClosed    = twoda.getRow(_soundAppType).getString("Closed");
-	_soundDestroyed = twoda.getRow(_soundAppType).getString("Destroyed");
-	_soundUsed      = twoda.getRow(_soundAppType).getString("Used");
-	_soundLocked    = twoda.getRow(_soundAppType).getString("Locked");
+	_soundOpened    = twoda.getRow(_soundAppType).getString(kColumnOpened);
+	_soundClosed    = twoda.getRow(_soundAppType).getString(kColumnClosed);
+	_soundDestroyed = twoda.getRow(_soundAppType).getString(kColumnDestroyed);
+	_soundUsed      = twoda.getRow(_soundAppType).getString(kColumnUsed);
+	_soundLocked    = twoda.getRow(_soundAppType).getString(kColumnLocked);
 }
 
 } // End of namespace NWN
@@ -57,6 +57,7 @@ const Common::UString &Animation::getName() const {
 
 void Animation::setName(Common::UString &name) {
 	_name = name;
+	_atom = Common::Atom(name);
 }
 
 void Animation::setLength(float length) {
@@ -76,7 +77,7 @@ void Animation::update(Model *model, float lastFrame, float nextFrame) {
 	//       for event in _events event->fire()
 
 
-	float scale = model->getAnimationScale(_name);
+	float scale = model->getAnimationScale(_atom);
 	for (NodeList::iterator n = nodeList.begin();
 	     n != nodeList.end(); ++n) {
 		(*n)->update(model, lastFrame, nextFrame, scale);
@@ -85,7 +86,7 @@ void Animation::update(Model *model, float lastFrame, float nextFrame) {
 
 void Animation::addAnimNode(AnimNode *node) {
 	nodeList.push_back(node);
-	nodeMap.insert(std::make_pair(node->getName(), node));
+	nodeMap.insert(std::make_pair(Common::Atom(node->getName()), node));
 }
 
 } // End of namespace Aurora
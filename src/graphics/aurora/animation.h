@@ -35,6 +35,7 @@
 #include <map>
 
 #include "common/ustring.h"
+#include "common/atom.h"
 #include "common/transmatrix.h"
 #include "common/boundingbox.h"
 
@@ -65,7 +66,7 @@ public:
 
 protected:
 	typedef std::list<AnimNode *> NodeList;
-	typedef std::map<Common::UString, AnimNode *, Common::UString::iless> NodeMap;
+	typedef std::map<Common::Atom, AnimNode *> NodeMap;
 
 	NodeList nodeList; ///< The nodes within the state.
 	NodeMap  nodeMap;  ///< The nodes within the state, indexed by name.
@@ -73,6 +74,7 @@ protected:
 	NodeList rootNodes; ///< The nodes in the state without a parent.
 
 	Common::UString _name; ///< The model's name.
+	Common::Atom    _atom; ///< The model's name, interned for fast look-ups.
 	float _length;
 	float _transtime;
 
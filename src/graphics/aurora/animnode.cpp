@@ -44,8 +44,10 @@ AnimNode::AnimNode(ModelNode *modelnode) :
 	_parent(0) {
 	// Actual data is loaded as a generic modelnode
 	_nodedata = modelnode;
-	if (modelnode)
+	if (modelnode) {
 		_name = modelnode->getName();
+		_atom = Common::Atom(_name);
+	}
 }
 
 AnimNode::~AnimNode() {
@@ -71,7 +73,7 @@ void AnimNode::update(Model *model, float lastFrame, float nextFrame, float scal
 	if (!_nodedata)
 		return;
 
-	ModelNode *target = model->getNode(_name);
+	ModelNode *target = model->getNode(_atom);
 	if (!target)
 		return;
 
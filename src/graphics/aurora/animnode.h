@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "common/ustring.h"
+#include "common/atom.h"
 #include "common/transmatrix.h"
 #include "common/boundingbox.h"
 
@@ -65,6 +66,7 @@ protected:
 	std::list<AnimNode *> _children; ///< The node's children.
 
 	Common::UString _name; ///< The node's name.
+	Common::Atom    _atom; ///< The node's name, interned for fast look-ups.
 	ModelNode *_nodedata;
 
 public:
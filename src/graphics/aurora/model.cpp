@@ -310,6 +310,10 @@ const Common::UString &Model::getState() const {
 }
 
 bool Model::hasNode(const Common::UString &node) const {
+	return hasNode(Common::Atom(node));
+}
+
+bool Model::hasNode(const Common::Atom &node) const {
 	if (!_currentState)
 		return false;
 
@@ -321,6 +325,14 @@ bool Model::hasNode(const Common::UString &node) const {
 }
 
 ModelNode *Model::getNode(const Common::UString &node) {
+	return getNode(Common::Atom(node));
+}
+
+const ModelNode *Model::getNode(const Common::UString &node) const {
+	return getNode(Common::Atom(node));
+}
+
+ModelNode *Model::getNode(const Common::Atom &node) {
 	if (!_currentState)
 		return 0;
 
@@ -335,7 +347,7 @@ ModelNode *Model::getNode(const Common::UString &node) {
 	return n->second;
 }
 
-const ModelNode *Model::getNode(const Common::UString &node) const {
+const ModelNode *Model::getNode(const Common::Atom &node) const {
 	if (!_currentState)
 		return 0;
 
@@ -351,7 +363,10 @@ const ModelNode *Model::getNode(const Common::UString &node) const {
 }
 
 Animation *Model::getAnimation(const Common::UString &anim) {
+	return getAnimation(Common::Atom(anim));
+}
 
+Animation *Model::getAnimation(const Common::Atom &anim) {
 	AnimationMap::iterator n = _animationMap.find(anim);
 	if (n == _animationMap.end()) {
 		if (_supermodel)
@@ -364,6 +379,10 @@ Animation *Model::getAnimation(const Common::UString &anim) {
 }
 
 float Model::getAnimationScale(const Common::UString &anim) {
+	return getAnimationScale(Common::Atom(anim));
+}
+
+float Model::getAnimationScale(const Common::Atom &anim) {
 	// TODO: We can cache this for performance
 	AnimationMap::iterator n = _animationMap.find(anim);
 	if (n == _animationMap.end()) {
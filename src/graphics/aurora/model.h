@@ -35,6 +35,7 @@
 #include <map>
 
 #include "common/ustring.h"
+#include "common/atom.h"
 #include "common/transmatrix.h"
 #include "common/boundingbox.h"
 
@@ -118,17 +119,25 @@ public:
 
 	/** Does the specified node exist in the current state? */
 	bool hasNode(const Common::UString &node) const;
+	/** Does the specified node exist in the current state? */
+	bool hasNode(const Common::Atom &node) const;
 
 	/** Get the specified node, from the current state. */
 	ModelNode *getNode(const Common::UString &node);
 	/** Get the specified node, from the current state. */
 	const ModelNode *getNode(const Common::UString &node) const;
+	/** Get the specified node, from the current state. */
+	ModelNode *getNode(const Common::Atom &node);
+	/** Get the specified node, from the current state. */
+	const ModelNode *getNode(const Common::Atom &node) const;
 
 
 	// Animation
 
 	/** Determine what animation scaling applies. */
 	float getAnimationScale(const Common::UString &anim);
+	/** Determine what animation scaling applies. */
+	float getAnimationScale(const Common::Atom &anim);
 
 	/** Play a named animation.
 	 *
@@ -149,8 +158,8 @@ public:
 
 protected:
 	typedef std::list<ModelNode *> NodeList;
-	typedef std::map<Common::UString, ModelNode *, Common::UString::iless> NodeMap;
-	typedef std::map<Common::UString, Animation *, Common::UString::iless> AnimationMap;
+	typedef std::map<Common::Atom, ModelNode *> NodeMap;
+	typedef std::map<Common::Atom, Animation *> AnimationMap;
 
 	/** A model state. */
 	struct State {
@@ -220,6 +229,8 @@ protected:
 
 	/** Get the animation from its name. */
 	Animation *getAnimation(const Common::UString &anim);
+	/** Get the animation from its name. */
+	Animation *getAnimation(const Common::Atom &anim);
 
 
 	/** Finalize the loading procedure. */
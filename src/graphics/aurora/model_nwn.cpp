@@ -394,7 +394,7 @@ void Model_NWN::addState(ParserContext &ctx) {
 	     n != ctx.nodes.end(); ++n) {
 
 		ctx.state->nodeList.push_back(*n);
-		ctx.state->nodeMap.insert(std::make_pair((*n)->getName(), *n));
+		ctx.state->nodeMap.insert(std::make_pair(Common::Atom((*n)->getName()), *n));
 
 		if (!(*n)->getParent())
 			ctx.state->rootNodes.push_back(*n);
@@ -459,7 +459,7 @@ void Model_NWN::readAnimBinary(ParserContext &ctx, uint32 offset) {
 	anim->setName(ctx.state->name);
 	anim->setLength(animLength);
 	anim->setTransTime(transTime);
-	_animationMap.insert(std::make_pair(ctx.state->name, anim));
+	_animationMap.insert(std::make_pair(Common::Atom(ctx.state->name), anim));
 	debugC(4, kDebugGraphics, "Loaded animation \"%s\" in model \"%s\"", ctx.state->name.c_str(), _name.c_str());
 
 	for (std::list<ModelNode *>::iterator n = ctx.nodes.begin();
@@ -193,7 +193,7 @@ void Model_Witcher::addState(ParserContext &ctx) {
 	     n != ctx.nodes.end(); ++n) {
 
 		ctx.state->nodeList.push_back(*n);
-		ctx.state->nodeMap.insert(std::make_pair((*n)->getName(), *n));
+		ctx.state->nodeMap.insert(std::make_pair(Common::Atom((*n)->getName()), *n));
 
 		if (!(*n)->getParent())
 			ctx.state->rootNodes.push_back(*n);
@@ -222,7 +222,7 @@ void ModelNode::reparent(ModelNode &parent) {
 	_level = parent._level + 1;
 
 	_model->_currentState->nodeList.push_back(this);
-	_model->_currentState->nodeMap.insert(std::make_pair(_name, this));
+	_model->_currentState->nodeMap.insert(std::make_pair(Common::Atom(_name), this));
 
 	for (std::list<ModelNode *>::iterator c = _children.begin(); c != _children.end(); ++c)
 		(*c)->reparent(parent);
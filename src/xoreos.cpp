@@ -245,6 +245,16 @@ void init() {
 	status("Sound subsystem initialized");
 	EventMan.init();
 	status("Event subsystem initialized");
+
+	// Cache the indices of the game's archives, if requested
+	Common::UString indexCache = ConfigMan.getString("indexcache");
+	if (!indexCache.empty())
+		ResMan.setIndexCacheDirectory(Common::FilePath::makeAbsolute(indexCache));
+
+	// Keep resource payloads in memory, up to the given number of MB
+	int resourceCache = ConfigMan.getInt("resourcecache", 0);
+	if (resourceCache > 0)
+		ResMan.setResourceCacheBudget(((uint32) MIN(resourceCache, 4095)) * 1024 * 1024);
 }
 
 void deinit() {